@@ -15,6 +15,7 @@ to reproduce, prepare derivative works, distribute copies to the public, perform
 #include "math.h"
 #include "string.h"
 #include "stdlib.h"
+#include "ctype.h"
 #include "app.h"
 #include "fft.h"
 #include "finish.h"
@@ -26,6 +27,9 @@ to reproduce, prepare derivative works, distribute copies to the public, perform
 #include "comm_lattice.h"
 #include "output.h"
 #include "solve.h"
+#include "core_energy.h"
+
+#include "style_core.h"
 
 using namespace PFDD_NS;
 
@@ -72,15 +76,31 @@ App::App(PFDD_C *pfdd_p, int narg, char **arg) : Pointers(pfdd_p)
   non_Schmid = 0;
   sites = NULL;
 
+  num_planes = 0;
   core_flag = -1;
+  core_style = NULL;
+  core = NULL;
+  core_table = 0;
   setup_flag = -1;
   int iarg = 1;
   while (iarg < narg) {
     if (strcmp(arg[iarg],"core_energy") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal app_style command");
       iarg += 1;
-      core_flag = atoi(arg[iarg]);
+      if (isdigit(arg[iarg][0])) core_flag = atoi(arg[iarg]);
+      else {
+        delete [] core_style;
+        core_style = new char[strlen(arg[iarg])+1];
+        strcpy(core_style,arg[iarg]);
+      }
       iarg += 1;
     }
+    else if (strcmp(arg[iarg],"core_table") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal app_style command");
+      core_table = atoi(arg[iarg+1]);
+      if (core_table < 0) error->all(FLERR,"Illegal app_style command");
+      iarg += 2;
+    }
     else if (strcmp(arg[iarg],"setup") == 0) {
       iarg += 1;
       set_initial_sxtal(arg[iarg]);
@@ -94,6 +114,8 @@ App::App(PFDD_C *pfdd_p, int narg, char **arg) : Pointers(pfdd_p)
 App::~App()
 {
   delete [] style;
+  delete [] core_style;
+  delete core;
 
   memory->destroy(id);
   memory->destroy(xyz);
@@ -474,6 +496,14 @@ void App::init()
   // fft-specific initialization, after general initialization
   // has to come before init_app()
   fft->init();
+
+  // core energy style, from its name or the core_energy number
+  // it and the dumps flag the fields the solver has to keep
+
+  fft->theta_flag = 0;
+  if (core == NULL) create_core();
+  if (core) core->init();
+
   // app-specific initialization, after general initialization
   init_app();
 
@@ -496,8 +526,10 @@ void App::setup()
 
   setup_app();
 
-  // FFT setup
+  // FFT setup, timed on its own as it is outside the loop
+  timer->stamp();
   fft->setup();
+  timer->stamp(TIME_SETUP);
 
   // second stage of app-specific setup
 
@@ -539,13 +571,37 @@ void App::resolSS()
    ---------------------------------------------------------------------*/
 void App::core_energy()
 {
-  if(core_flag == 1) fft->core_energy_perfect();
-  else if(core_flag == 2) fft->core_energy_extended();
-  else if(core_flag == 3) fft->core_energy_sine();
-  else if(core_flag == 4) fft->core_energy_pyrII();// Claire changed 8/1/18: was core_energy_isf_usf
-  else if(core_flag == 5) fft->core_energy_bcc_perfect();
-  else if(core_flag == 6) fft->core_energy_USFE_angle_tau();  //added_HJ
-  else if(core_flag == 7) fft->core_energy_mpea(); //added LTWS
+  if (core) core->compute();
+}
+
+/* ----------------------------------------------------------------------
+   create the core energy style, core_energy numbers 1 to 7 map to the
+   styles they used to select, no style without either
+------------------------------------------------------------------------- */
+
+void App::create_core()
+{
+  const char *numbered[] = {"perfect","extended","sine","pyrII",
+                            "bcc_perfect","usfe_angle_tau","mpea"};
+  const char *name;
+
+  if (core_style) name = core_style;
+  else if (core_flag == -1) return;
+  else if (core_flag < 1 || core_flag > 7)
+    error->all(FLERR,"Illegal core_energy number");
+  else name = numbered[core_flag-1];
+
+  char *arg = const_cast<char *>(name);
+
+  if (0) return;
+
+#define CORE_CLASS
+#define CoreStyle(key,Class) \
+  else if (strcmp(name,#key) == 0) core = new Class(pfdd_p,1,&arg);
+#include "style_core.h"
+#undef CORE_CLASS
+
+  else error->all(FLERR,"Unknown core_energy style");
 }
 
 /* ----------------------------------------------------------------------
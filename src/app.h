@@ -39,6 +39,9 @@ class App : protected Pointers {
   double t_inverse;       // 1/kT
   double timestep;        // timestep
   int core_flag;        // Flag for the core energy model: 1 perfect, 2 extended, 3
+  char *core_style;     // core energy style by name, overrides core_flag
+  class CoreEnergy *core;   // core energy style of the run
+  int core_table;       // intervals of the tabulated 1d core energy, 0 = exact
   int setup_flag;         //Flag for initial dislocation setup
   int dimension;        // Dimensionality of the calculation
   double nextoutput;
@@ -157,6 +160,7 @@ class App : protected Pointers {
 
   void create_arrays();
   void recreate_arrays();
+  void create_core();
   int contiguous_sites();
 };
 
@@ -164,3 +168,16 @@ class App : protected Pointers {
 
 #endif
 
+/* ERROR/WARNING messages:
+
+E: Illegal core_energy number
+
+The core_energy keyword of app_style takes 1 to 7 or the name of a
+core energy style.
+
+E: Unknown core_energy style
+
+The name given to the core_energy keyword of app_style is not one of
+the core energy styles compiled into PFDD.
+
+*/
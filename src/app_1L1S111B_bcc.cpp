@@ -117,6 +117,8 @@ double App1L1S111Bbcc::compute_mean_xi(int n, int flag)
 {
   int lN1 = fft->local_x;
   int lxs = fft->local_x_start;
+  int lys = fft->local_y_start;
+  int lzs = fft->local_z_start;
   int N2 = fft->local_y;
   int N3 = fft->local_z;
   int NS = fft->slip_systems;
@@ -124,8 +126,8 @@ double App1L1S111Bbcc::compute_mean_xi(int n, int flag)
   int na=-1;
 
   int i=siteijk[n][0] - lxs;
-  int j=siteijk[n][1];
-  int k=siteijk[n][2];
+  int j=siteijk[n][1] - lys;
+  int k=siteijk[n][2] - lzs;
 
   if(flag == 1){ // 1 slip system, real value
     slip = 0;
@@ -147,6 +149,8 @@ double App1L1S111Bbcc::compute_theta(int n, int flag)
 {
   int lN1 = fft->local_x;
   int lxs = fft->local_x_start;
+  int lys = fft->local_y_start;
+  int lzs = fft->local_z_start;
   int N2 = fft->local_y;
   int N3 = fft->local_z;
   int NS = fft->slip_systems;
@@ -154,8 +158,8 @@ double App1L1S111Bbcc::compute_theta(int n, int flag)
   int na=-1;
 
   int i=siteijk[n][0] - lxs;
-  int j=siteijk[n][1];
-  int k=siteijk[n][2];
+  int j=siteijk[n][1] - lys;
+  int k=siteijk[n][2] - lzs;
 
   if(flag == 1){ // 1 slip system, real value
     slip = 0;
@@ -173,6 +177,8 @@ double App1L1S111Bbcc::compute_stress(int n, int flag)
 {
   int lN1 = fft->local_x;
   int lxs = fft->local_x_start;
+  int lys = fft->local_y_start;
+  int lzs = fft->local_z_start;
   int N2 = fft->local_y;
   int N3 = fft->local_z;
   int NS = fft->slip_systems;
@@ -181,8 +187,8 @@ double App1L1S111Bbcc::compute_stress(int n, int flag)
   int na=-1;
 
   int i=siteijk[n][0] - lxs;
-  int j=siteijk[n][1];
-  int k=siteijk[n][2];
+  int j=siteijk[n][1] - lys;
+  int k=siteijk[n][2] - lzs;
 
   if(flag == 1)  // pxx
     na = 2*(i*N2*N3 + j*N3 + k + 0*lN1*N2*N3 + 0*lN1*N2*N3*ND);
@@ -208,6 +214,8 @@ double App1L1S111Bbcc::compute_strain(int n, int flag)
 {
   int lN1 = fft->local_x;
   int lxs = fft->local_x_start;
+  int lys = fft->local_y_start;
+  int lzs = fft->local_z_start;
   int N2 = fft->local_y;
   int N3 = fft->local_z;
   int NS = fft->slip_systems;
@@ -216,8 +224,8 @@ double App1L1S111Bbcc::compute_strain(int n, int flag)
   int na=-1;
 
   int i=siteijk[n][0] - lxs;
-  int j=siteijk[n][1];
-  int k=siteijk[n][2];
+  int j=siteijk[n][1] - lys;
+  int k=siteijk[n][2] - lzs;
 
   if(flag == 1)  // exx
     na = 2*(i*N2*N3 + j*N3 + k + 0*lN1*N2*N3 + 0*lN1*N2*N3*ND);
@@ -262,6 +262,8 @@ double App1L1S100B::compute_mean_xi(int n, int flag)
 {
   int lN1 = fft->local_x;
   int lxs = fft->local_x_start;
+  int lys = fft->local_y_start;
+  int lzs = fft->local_z_start;
   int N2 = fft->local_y;
   int N3 = fft->local_z;
   int NS = fft->slip_systems;
@@ -269,8 +271,8 @@ double App1L1S100B::compute_mean_xi(int n, int flag)
   int na=-1;
 
   int i=siteijk[n][0] - lxs;
-  int j=siteijk[n][1];
-  int k=siteijk[n][2];
+  int j=siteijk[n][1] - lys;
+  int k=siteijk[n][2] - lzs;
 
   if(flag == 1){ // 1 slip system, real value
     slip = 0;
@@ -292,6 +294,8 @@ double App1L1S100B::compute_stress(int n, int flag)
 {
   int lN1 = fft->local_x;
   int lxs = fft->local_x_start;
+  int lys = fft->local_y_start;
+  int lzs = fft->local_z_start;
   int N2 = fft->local_y;
   int N3 = fft->local_z;
   int NS = fft->slip_systems;
@@ -300,8 +304,8 @@ double App1L1S100B::compute_stress(int n, int flag)
   int na=-1;
 
   int i=siteijk[n][0] - lxs;
-  int j=siteijk[n][1];
-  int k=siteijk[n][2];
+  int j=siteijk[n][1] - lys;
+  int k=siteijk[n][2] - lzs;
 
   if(flag == 1)  // pxx
     na = 2*(i*N2*N3 + j*N3 + k + 0*lN1*N2*N3 + 0*lN1*N2*N3*ND);
@@ -327,6 +331,8 @@ double App1L1S100B::compute_theta(int n, int flag)
 {
   int lN1 = fft->local_x;
   int lxs = fft->local_x_start;
+  int lys = fft->local_y_start;
+  int lzs = fft->local_z_start;
   int N2 = fft->local_y;
   int N3 = fft->local_z;
   int NS = fft->slip_systems;
@@ -334,8 +340,8 @@ double App1L1S100B::compute_theta(int n, int flag)
   int na=-1;
 
   int i=siteijk[n][0] - lxs;
-  int j=siteijk[n][1];
-  int k=siteijk[n][2];
+  int j=siteijk[n][1] - lys;
+  int k=siteijk[n][2] - lzs;
 
   if(flag == 1){ // 1 slip system, real value
     slip = 0;
@@ -349,6 +355,8 @@ double App1L1S100B::compute_delta(int n, int flag)
 {
   int lN1 = fft->local_x;
   int lxs = fft->local_x_start;
+  int lys = fft->local_y_start;
+  int lzs = fft->local_z_start;
   int N2 = fft->local_y;
   int N3 = fft->local_z;
   int NS = fft->slip_systems;
@@ -356,8 +364,8 @@ double App1L1S100B::compute_delta(int n, int flag)
   int na=-1;
 
   int i=siteijk[n][0] - lxs;
-  int j=siteijk[n][1];
-  int k=siteijk[n][2];
+  int j=siteijk[n][1] - lys;
+  int k=siteijk[n][2] - lzs;
 
   if(flag == 1){ // 1 slip system
     slip = 0;
@@ -370,6 +378,8 @@ double App1L1S100B::compute_ddelta(int n, int flag)
 {
   int lN1 = fft->local_x;
   int lxs = fft->local_x_start;
+  int lys = fft->local_y_start;
+  int lzs = fft->local_z_start;
   int N2 = fft->local_y;
   int N3 = fft->local_z;
   int NS = fft->slip_systems;
@@ -377,8 +387,8 @@ double App1L1S100B::compute_ddelta(int n, int flag)
   int na=-1;
 
   int i=siteijk[n][0] - lxs;
-  int j=siteijk[n][1];
-  int k=siteijk[n][2];
+  int j=siteijk[n][1] - lys;
+  int k=siteijk[n][2] - lzs;
 
   if(flag == 1){ // 1 slip system
     slip = 0;
@@ -396,6 +406,8 @@ double App1L1S100B::compute_strain(int n, int flag)
 {
   int lN1 = fft->local_x;
   int lxs = fft->local_x_start;
+  int lys = fft->local_y_start;
+  int lzs = fft->local_z_start;
   int N2 = fft->local_y;
   int N3 = fft->local_z;
   int NS = fft->slip_systems;
@@ -404,8 +416,8 @@ double App1L1S100B::compute_strain(int n, int flag)
   int na=-1;
 
   int i=siteijk[n][0] - lxs;
-  int j=siteijk[n][1];
-  int k=siteijk[n][2];
+  int j=siteijk[n][1] - lys;
+  int k=siteijk[n][2] - lzs;
 
   if(flag == 1)  // exx
     na = 2*(i*N2*N3 + j*N3 + k + 0*lN1*N2*N3 + 0*lN1*N2*N3*ND);
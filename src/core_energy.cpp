@@ -0,0 +1,52 @@
+/* ----------------------------------------------------------------------
+PFDD -- Phase Field Dislocation Dynamics
+
+© 2022. Triad National Security, LLC. All rights reserved.
+This program was produced under U.S. Government contract 89233218CNA000001 for
+Los Alamos National Laboratory (LANL), which is operated by Triad National
+Security, LLC for the U.S. Department of Energy/National Nuclear Security
+Administration. All rights in the program are reserved by Triad National
+Security, LLC, and the U.S. Department of Energy/National Nuclear Security
+Administration. The Government is granted for itself and others acting on its
+behalf a nonexclusive, paid-up, irrevocable worldwide license in this material 
+to reproduce, prepare derivative works, distribute copies to the public, perform
+ publicly and display publicly, and to permit others to do so.
+------------------------------------------------------------------------- */
+
+#include "mpi.h"
+#include "string.h"
+#include "core_energy.h"
+#include "fft.h"
+
+using namespace PFDD_NS;
+
+/* ---------------------------------------------------------------------- */
+
+CoreEnergy::CoreEnergy(PFDD_C *pfdd_p, int, char **arg) :
+  Pointers(pfdd_p)
+{
+  int n = strlen(arg[0]) + 1;
+  style = new char[n];
+  strcpy(style,arg[0]);
+
+  MPI_Comm_rank(world,&me);
+  grid_data = 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+CoreEnergy::~CoreEnergy()
+{
+  delete [] style;
+}
+
+/* ----------------------------------------------------------------------
+   core energy of all local sites in one tile, into fft->E_core
+------------------------------------------------------------------------- */
+
+void CoreEnergy::compute()
+{
+  setup();
+  int nsite = fft->local_x*fft->local_y*fft->local_z;
+  fft->E_core = tile(0,nsite)/fft->nx;
+}
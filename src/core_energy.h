@@ -0,0 +1,48 @@
+/* ----------------------------------------------------------------------
+PFDD -- Phase Field Dislocation Dynamics
+
+© 2022. Triad National Security, LLC. All rights reserved.
+This program was produced under U.S. Government contract 89233218CNA000001 for
+Los Alamos National Laboratory (LANL), which is operated by Triad National
+Security, LLC for the U.S. Department of Energy/National Nuclear Security
+Administration. All rights in the program are reserved by Triad National
+Security, LLC, and the U.S. Department of Energy/National Nuclear Security
+Administration. The Government is granted for itself and others acting on its
+behalf a nonexclusive, paid-up, irrevocable worldwide license in this material 
+to reproduce, prepare derivative works, distribute copies to the public, perform
+ publicly and display publicly, and to permit others to do so.
+------------------------------------------------------------------------- */
+
+#ifndef PFDD_CORE_ENERGY_H
+#define PFDD_CORE_ENERGY_H
+
+#include "pointers.h"
+
+namespace PFDD_NS {
+
+// core energy E_core and its derivative dE_core of every slip system,
+// evaluated over a range of the local sites so a solver can interleave
+// it with its other sweeps over the slab
+
+class CoreEnergy : protected Pointers {
+ public:
+  char *style;
+  int me;
+  int grid_data;                  // 1 if parameters are per site of the grid
+
+  CoreEnergy(class PFDD_C *, int, char **);
+  virtual ~CoreEnergy();
+  virtual void init() {}          // each run, once the material is set
+  virtual void setup() {}         // each iteration, before the first tile
+
+  // local sites lo to hi-1, the same range on every slip system
+  // returns the sum of their core energies
+
+  virtual double tile(int, int) = 0;
+
+  void compute();
+};
+
+}
+
+#endif
@@ -0,0 +1,154 @@
+/* ----------------------------------------------------------------------
+PFDD -- Phase Field Dislocation Dynamics
+
+© 2022. Triad National Security, LLC. All rights reserved.
+This program was produced under U.S. Government contract 89233218CNA000001 for
+Los Alamos National Laboratory (LANL), which is operated by Triad National
+Security, LLC for the U.S. Department of Energy/National Nuclear Security
+Administration. All rights in the program are reserved by Triad National
+Security, LLC, and the U.S. Department of Energy/National Nuclear Security
+Administration. The Government is granted for itself and others acting on its
+behalf a nonexclusive, paid-up, irrevocable worldwide license in this material 
+to reproduce, prepare derivative works, distribute copies to the public, perform
+ publicly and display publicly, and to permit others to do so.
+------------------------------------------------------------------------- */
+
+#include "math.h"
+#include "core_extended.h"
+#include "fft.h"
+#include "material.h"
+#include "error.h"
+
+using namespace PFDD_NS;
+
+// exp(2 pi i x), and the products a b and a conj(b) of unit phases
+
+typedef struct { double re, im; } Phase;
+
+static inline Phase unit_phase(double x)
+{
+  Phase e;
+  e.re = cos(2.0*M_PI*x);
+  e.im = sin(2.0*M_PI*x);
+  return e;
+}
+
+static inline Phase cmul(Phase a, Phase b)
+{
+  Phase c;
+  c.re = a.re*b.re - a.im*b.im;
+  c.im = a.re*b.im + a.im*b.re;
+  return c;
+}
+
+static inline Phase cmulc(Phase a, Phase b)
+{
+  Phase c;
+  c.re = a.re*b.re + a.im*b.im;
+  c.im = a.im*b.re - a.re*b.im;
+  return c;
+}
+
+/* ---------------------------------------------------------------------- */
+
+CoreExtended::CoreExtended(PFDD_C *pfdd_p, int narg, char **arg) :
+  CoreEnergy(pfdd_p,narg,arg) {}
+
+/* ----------------------------------------------------------------------
+   Claire added extended energy 07/30/18 to account for partial
+   dislocations and the Schoeck parameterization
+------------------------------------------------------------------------- */
+
+void CoreExtended::init()
+{
+  if (fft->slip_systems != 3*fft->num_planes)
+    error->all(FLERR,"Core energy style extended needs 3 slip systems per plane");
+
+  Material *material = fft->material;
+  double mu = material->mu;
+
+  c0 = material->c0/mu;
+  c1 = material->c1/mu;
+  c2 = material->c2/mu;
+  c3 = material->c3/mu;
+  c4 = material->c4/mu;
+  a1c = material->a1/mu;
+  a3c = material->a3/mu;
+  scale = 1.0/(material->dslip*material->b);
+}
+
+/* ---------------------------------------------------------------------- */
+
+double CoreExtended::tile(int lo, int hi)
+{
+  int NP = fft->num_planes;
+
+  if (NP == 1) return planes<1>(lo,hi);
+  if (NP == 2) return planes<2>(lo,hi);
+  if (NP == 3) return planes<3>(lo,hi);
+  if (NP == 4) return planes<4>(lo,hi);
+  return planes<0>(lo,hi);
+}
+
+/* ----------------------------------------------------------------------
+   slip systems 3*plane to 3*plane+2 are the three partials of a plane,
+   the planes have to be in this order initially
+   fcore and df1core..df3core are per plane, dE_core per slip system
+------------------------------------------------------------------------- */
+
+template <int NP>
+double CoreExtended::planes(int lo, int hi)
+{
+  int np = NP ? NP : fft->num_planes;
+  int nsite = fft->local_x*fft->local_y*fft->local_z;
+  const double *x = fft->xi[0];
+  double *fcore = fft->fcore;
+  double *df1core = fft->df1core;
+  double *df2core = fft->df2core;
+  double *df3core = fft->df3core;
+  double *dE_core = fft->dE_core;
+  double dscale = 2.0*M_PI*scale;
+  double esum = 0.0;
+
+  for (int plane = 0; plane < np; plane++) {
+    for (int m = lo; m < hi; m++) {
+      int index = m + plane*nsite;
+      int index1 = m + (3*plane)*nsite;
+      int index2 = m + (3*plane+1)*nsite;
+      int index3 = m + (3*plane+2)*nsite;
+
+      /* with E_a = exp(2 pi i xi_a) every angle below is an integer
+      combination of the differences, D12 = E1 conj(E2) is xi1-xi2 */
+
+      Phase e1 = unit_phase(x[2*index1]);
+      Phase e2 = unit_phase(x[2*index2]);
+      Phase e3 = unit_phase(x[2*index3]);
+      Phase d12 = cmulc(e1,e2), d23 = cmulc(e2,e3), d31 = cmulc(e3,e1);
+      Phase q12 = cmul(d12,d12), q23 = cmul(d23,d23), q31 = cmul(d31,d31);
+      Phase a1 = cmulc(d12,d31);       // 2xi1-xi2-xi3
+      Phase a2 = cmulc(d23,d12);       // 2xi2-xi3-xi1
+      Phase a3 = cmulc(d31,d23);       // 2xi3-xi1-xi2
+      Phase b1 = cmulc(a1,d31);        // 3xi1-xi2-2xi3
+      Phase b2 = cmul(a1,d12);         // 3xi1-2xi2-xi3
+      Phase b3 = cmulc(a2,d12);        // 3xi2-xi3-2xi1
+      Phase b4 = cmul(a2,d23);         // 3xi2-2xi3-xi1
+      Phase b5 = cmulc(a3,d23);        // 3xi3-xi1-2xi2
+      Phase b6 = cmul(a3,d31);         // 3xi3-2xi1-xi2
+
+      double e = scale*(c0 + c1*(d12.re + d23.re + d31.re) + c2*(a1.re + a2.re + a3.re) + c3*(q12.re + q23.re + q31.re) + c4*(b1.re + b2.re + b3.re + b4.re + b5.re + b6.re) + a1c*(d12.im + d23.im + d31.im) + a3c*(q12.im + q23.im + q31.im));
+      fcore[index] = e;
+      esum += e;
+
+      /*partial derivatives wrt phase fields 1, 2 and 3*/
+      double de1 = dscale*(c1*(d31.im - d12.im) + c2*(a2.im + a3.im - 2.0*a1.im) + (2.0*c3)*(q31.im - q12.im) + c4*(2.0*b3.im + b4.im + b5.im + 2.0*b6.im - 3.0*b1.im - 3.0*b2.im) + a1c*(d12.re - d31.re) + (2.0*a3c)*(q12.re - q31.re));
+      double de2 = dscale*(c1*(d12.im - d23.im) + c2*(a1.im + a3.im - 2.0*a2.im) + (2.0*c3)*(q12.im - q23.im) + c4*(b1.im + 2.0*b2.im + 2.0*b5.im + b6.im - 3.0*b3.im - 3.0*b4.im) + a1c*(d23.re - d12.re) + (2.0*a3c)*(q23.re - q12.re));
+      double de3 = dscale*(c1*(d23.im - d31.im) + c2*(a1.im + a2.im - 2.0*a3.im) + (2.0*c3)*(q23.im - q31.im) + c4*(2.0*b1.im + b2.im + b3.im + 2.0*b4.im - 3.0*b5.im - 3.0*b6.im) + a1c*(d31.re - d23.re) + (2.0*a3c)*(q31.re - q23.re));
+
+      df1core[index] = dE_core[index1] = de1;
+      df2core[index] = dE_core[index2] = de2;
+      df3core[index] = dE_core[index3] = de3;
+    }
+  }
+
+  return esum;
+}
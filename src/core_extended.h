@@ -0,0 +1,56 @@
+/* ----------------------------------------------------------------------
+PFDD -- Phase Field Dislocation Dynamics
+
+© 2022. Triad National Security, LLC. All rights reserved.
+This program was produced under U.S. Government contract 89233218CNA000001 for
+Los Alamos National Laboratory (LANL), which is operated by Triad National
+Security, LLC for the U.S. Department of Energy/National Nuclear Security
+Administration. All rights in the program are reserved by Triad National
+Security, LLC, and the U.S. Department of Energy/National Nuclear Security
+Administration. The Government is granted for itself and others acting on its
+behalf a nonexclusive, paid-up, irrevocable worldwide license in this material 
+to reproduce, prepare derivative works, distribute copies to the public, perform
+ publicly and display publicly, and to permit others to do so.
+------------------------------------------------------------------------- */
+
+#ifdef CORE_CLASS
+CoreStyle(extended,CoreExtended)
+
+#else
+
+#ifndef PFDD_CORE_EXTENDED_H
+#define PFDD_CORE_EXTENDED_H
+
+#include "core_energy.h"
+
+namespace PFDD_NS {
+
+// gamma surface of the three slip systems on each plane, fcc {111} or
+// hcp {0001} with partial dislocations in the Schoeck parameterization
+
+class CoreExtended : public CoreEnergy {
+ public:
+  CoreExtended(class PFDD_C *, int, char **);
+  void init();
+  double tile(int, int);
+
+ private:
+  double c0,c1,c2,c3,c4,a1c,a3c;  // Fourier coefficients over mu
+  double scale;                   // 1/(dslip b)
+
+  template <int NP> double planes(int, int);
+};
+
+}
+
+#endif
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Core energy style extended needs 3 slip systems per plane
+
+The extended core energy couples the three slip systems on each plane,
+the app has to define 3 times as many slip systems as planes.
+
+*/
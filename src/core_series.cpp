@@ -0,0 +1,268 @@
+/* ----------------------------------------------------------------------
+PFDD -- Phase Field Dislocation Dynamics
+
+© 2022. Triad National Security, LLC. All rights reserved.
+This program was produced under U.S. Government contract 89233218CNA000001 for
+Los Alamos National Laboratory (LANL), which is operated by Triad National
+Security, LLC for the U.S. Department of Energy/National Nuclear Security
+Administration. All rights in the program are reserved by Triad National
+Security, LLC, and the U.S. Department of Energy/National Nuclear Security
+Administration. The Government is granted for itself and others acting on its
+behalf a nonexclusive, paid-up, irrevocable worldwide license in this material 
+to reproduce, prepare derivative works, distribute copies to the public, perform
+ publicly and display publicly, and to permit others to do so.
+------------------------------------------------------------------------- */
+
+#include "mpi.h"
+#include "math.h"
+#include "string.h"
+#include "stdio.h"
+#include "core_series.h"
+#include "app.h"
+#include "fft.h"
+#include "material.h"
+#include "memory.h"
+
+using namespace PFDD_NS;
+
+enum{PERFECT,SINE,PYRII};
+
+/* ---------------------------------------------------------------------- */
+
+CoreSeries::CoreSeries(PFDD_C *pfdd_p, int narg, char **arg) :
+  CoreEnergy(pfdd_p,narg,arg)
+{
+  if (strcmp(style,"perfect") == 0) model = PERFECT;
+  else if (strcmp(style,"sine") == 0) model = SINE;
+  else model = PYRII;
+
+  order = 0;
+  for (int m = 0; m <= 4; m++) a[m] = b[m] = 0.0;
+  f = NULL;
+
+  table = NULL;
+  ntable = 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+CoreSeries::~CoreSeries()
+{
+  memory->destroy(table);
+}
+
+/* ----------------------------------------------------------------------
+   series coefficients from the material, reduced by mu dslip b
+------------------------------------------------------------------------- */
+
+void CoreSeries::init()
+{
+  Material *material = fft->material;
+  double norm = material->mu*material->dslip*material->b;
+  int m;
+
+  for (m = 0; m <= 4; m++) a[m] = b[m] = 0.0;
+  f = NULL;
+
+  if (model == PERFECT) {
+    // An sin^2(pi xi)
+
+    double An = material->An/norm;
+    order = 1;
+    a[0] = 0.5*An;
+    a[1] = -0.5*An;
+
+  } else if (model == SINE) {
+    /* Added by Claire 8/1/18: a 1D Sine approximations for use modeling hcp
+    non-basal slip planes with GSFE that suggests partial dislocations */
+    // isf sin^2(pi xi) + Cn sin^2(2 pi xi)
+
+    double isf = material->isf/norm;
+    double Cn = (material->usf - (isf/2.0))/norm;
+    order = 2;
+    a[0] = 0.5*(isf + Cn);
+    a[1] = -0.5*isf;
+    a[2] = -0.5*Cn;
+
+  } else {
+    /* Changed by Claire 8/1/18: was core_energy_isf_usf but I
+    changed to core_energy_pyrII to account for pyramidal II slip in HCP uses
+    a fourier series to parameterize the 1D GSFE that governs the dissociation of
+    perfect dislocations into partials with Burgers vectors in the same Direction
+    with half the magnitude. The GSFE curve isn't symmetric which is why the
+    parameterization is different than that for core_flag == 3, the sine approx */
+
+    order = 4;
+    a[0] = material->aa0/norm;
+    a[1] = material->aa1/norm;
+    a[2] = material->aa2/norm;
+    a[3] = material->aa3/norm;
+    a[4] = material->aa4/norm;
+    b[1] = material->bb1/norm;
+    b[2] = material->bb2/norm;
+    b[3] = material->bb3/norm;
+    b[4] = material->bb4/norm;
+
+    // fcore holds one slip system per plane
+
+    if (fft->slip_systems <= fft->num_planes) f = fft->fcore;
+  }
+
+  if (app->core_table > 0) table_build(app->core_table);
+  else {
+    memory->destroy(table);
+    ntable = 0;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   E = a0 + sum_m a_m cos(2 pi m xi) + b_m sin(2 pi m xi), m = 1..order,
+   and dE/dxi on the sites of the tile, the slip system count is a
+   template argument for the common 1 to 3, 0 is any
+------------------------------------------------------------------------- */
+
+double CoreSeries::tile(int lo, int hi)
+{
+  int NS = fft->slip_systems;
+
+  if (ntable) {
+    if (NS == 1) return lookup<1>(lo,hi);
+    if (NS == 2) return lookup<2>(lo,hi);
+    if (NS == 3) return lookup<3>(lo,hi);
+    return lookup<0>(lo,hi);
+  }
+
+  if (order == 1) {
+    if (NS == 1) return series<1,1>(lo,hi);
+    if (NS == 2) return series<1,2>(lo,hi);
+    if (NS == 3) return series<1,3>(lo,hi);
+    return series<1,0>(lo,hi);
+  }
+  if (order == 2) {
+    if (NS == 1) return series<2,1>(lo,hi);
+    if (NS == 2) return series<2,2>(lo,hi);
+    if (NS == 3) return series<2,3>(lo,hi);
+    return series<2,0>(lo,hi);
+  }
+  if (NS == 1) return series<4,1>(lo,hi);
+  if (NS == 2) return series<4,2>(lo,hi);
+  if (NS == 3) return series<4,3>(lo,hi);
+  return series<4,0>(lo,hi);
+}
+
+/* ----------------------------------------------------------------------
+   the harmonics follow from cos and sin of 2 pi xi by the Chebyshev
+   recurrence, one sin/cos pair per site
+------------------------------------------------------------------------- */
+
+template <int ORDER, int NS>
+double CoreSeries::series(int lo, int hi)
+{
+  int ns = NS ? NS : fft->slip_systems;
+  int nsite = fft->local_x*fft->local_y*fft->local_z;
+  const double *x = fft->xi[0];
+  double *dE = fft->dE_core;
+  double esum = 0.0;
+
+  for (int isa = 0; isa < ns; isa++) {
+    int offset = isa*nsite;
+    for (int m = offset+lo; m < offset+hi; m++) {
+      double u = 2.0*M_PI*x[2*m];
+      double c1 = cos(u), s1 = sin(u);
+      double cm = c1, sm = s1, cp = 1.0, sp = 0.0;
+      double e = a[0], de = 0.0;
+      for (int h = 1; h <= ORDER; h++) {
+        e += a[h]*cm + b[h]*sm;
+        de += (2.0*M_PI*h)*(b[h]*cm - a[h]*sm);
+        double cn = 2.0*c1*cm - cp;
+        double sn = 2.0*c1*sm - sp;
+        cp = cm; sp = sm;
+        cm = cn; sm = sn;
+      }
+      dE[m] = de;
+      if (f) f[m] = e;
+      esum += e;
+    }
+  }
+
+  return esum;
+}
+
+/* ----------------------------------------------------------------------
+   the series read from its cubic Hermite table
+------------------------------------------------------------------------- */
+
+template <int NS>
+double CoreSeries::lookup(int lo, int hi)
+{
+  int ns = NS ? NS : fft->slip_systems;
+  int nsite = fft->local_x*fft->local_y*fft->local_z;
+  const double *x = fft->xi[0];
+  double *dE = fft->dE_core;
+  double *fs = f;
+  int nt = ntable;
+  double h = 1.0/nt;
+  const double *t0 = table;
+  double esum = 0.0;
+
+  for (int isa = 0; isa < ns; isa++) {
+    int offset = isa*nsite;
+#pragma omp simd reduction(+:esum)
+    for (int m = offset+lo; m < offset+hi; m++) {
+      double y = x[2*m] - floor(x[2*m]);
+      int q = MIN(static_cast<int>(y*nt), nt-1);
+      double t = y*nt - q;
+      double t2 = t*t, t3 = t2*t;
+      double h00 = 2.0*t3 - 3.0*t2 + 1.0;
+      double h10 = h*(t3 - 2.0*t2 + t);
+      double h01 = 3.0*t2 - 2.0*t3;
+      double h11 = h*(t3 - t2);
+      const double *p = t0 + 3*q;
+      double e = h00*p[0] + h10*p[1] + h01*p[3] + h11*p[4];
+      dE[m] = h00*p[1] + h10*p[2] + h01*p[4] + h11*p[5];
+      if (fs) fs[m] = e;
+      esum += e;
+    }
+  }
+
+  return esum;
+}
+
+/* ----------------------------------------------------------------------
+   E and its first two derivatives at nt+1 nodes over one period of xi
+   cubic Hermite interpolation between them is off by at most
+   h^4/384 max|E| in E and h^4/384 max|E'| in dE/dxi, h = 1/nt
+------------------------------------------------------------------------- */
+
+void CoreSeries::table_build(int nt)
+{
+  memory->destroy(table);
+  memory->create(table,3*(nt+1),"core:table");
+
+  for (int q = 0; q <= nt; q++) {
+    double u = 2.0*M_PI*q/nt;
+    double e = a[0], de = 0.0, d2e = 0.0;
+    for (int m = 1; m <= order; m++) {
+      double w = 2.0*M_PI*m;
+      double c = cos(m*u), s = sin(m*u);
+      e += a[m]*c + b[m]*s;
+      de += w*(b[m]*c - a[m]*s);
+      d2e -= w*w*(a[m]*c + b[m]*s);
+    }
+    table[3*q] = e;
+    table[3*q+1] = de;
+    table[3*q+2] = d2e;
+  }
+  ntable = nt;
+
+  double d4 = 0.0, d5 = 0.0;
+  for (int m = 1; m <= order; m++) {
+    double w = 2.0*M_PI*m;
+    d4 += w*w*w*w*(fabs(a[m]) + fabs(b[m]));
+    d5 += w*w*w*w*w*(fabs(a[m]) + fabs(b[m]));
+  }
+  double h4 = 1.0/(static_cast<double>(nt)*nt*nt*nt*384.0);
+  if (me == 0)
+    printf("Core energy table of %d intervals, error below %g in E and %g in dE\n",
+           nt,d4*h4,d5*h4);
+}
@@ -0,0 +1,57 @@
+/* ----------------------------------------------------------------------
+PFDD -- Phase Field Dislocation Dynamics
+
+© 2022. Triad National Security, LLC. All rights reserved.
+This program was produced under U.S. Government contract 89233218CNA000001 for
+Los Alamos National Laboratory (LANL), which is operated by Triad National
+Security, LLC for the U.S. Department of Energy/National Nuclear Security
+Administration. All rights in the program are reserved by Triad National
+Security, LLC, and the U.S. Department of Energy/National Nuclear Security
+Administration. The Government is granted for itself and others acting on its
+behalf a nonexclusive, paid-up, irrevocable worldwide license in this material 
+to reproduce, prepare derivative works, distribute copies to the public, perform
+ publicly and display publicly, and to permit others to do so.
+------------------------------------------------------------------------- */
+
+#ifdef CORE_CLASS
+CoreStyle(perfect,CoreSeries)
+CoreStyle(sine,CoreSeries)
+CoreStyle(pyrII,CoreSeries)
+
+#else
+
+#ifndef PFDD_CORE_SERIES_H
+#define PFDD_CORE_SERIES_H
+
+#include "core_energy.h"
+
+namespace PFDD_NS {
+
+// 1d gamma surface of each slip system as a Fourier series in 2 pi xi
+// up to order 4, optionally tabulated over one period with core_table
+
+class CoreSeries : public CoreEnergy {
+ public:
+  CoreSeries(class PFDD_C *, int, char **);
+  ~CoreSeries();
+  void init();
+  double tile(int, int);
+
+ private:
+  int model;                  // PERFECT, SINE or PYRII
+  int order;                  // highest harmonic of the series
+  double a[5],b[5];           // its cos and sin coefficients
+  double *f;                  // E per site is kept here unless NULL
+
+  double *table;              // E, dE/dxi, d2E/dxi2 at the table nodes
+  int ntable;                 // intervals of the table, 0 = none
+
+  template <int ORDER, int NS> double series(int, int);
+  template <int NS> double lookup(int, int);
+  void table_build(int);
+};
+
+}
+
+#endif
+#endif
@@ -0,0 +1,151 @@
+/* ----------------------------------------------------------------------
+PFDD -- Phase Field Dislocation Dynamics
+
+© 2022. Triad National Security, LLC. All rights reserved.
+This program was produced under U.S. Government contract 89233218CNA000001 for
+Los Alamos National Laboratory (LANL), which is operated by Triad National
+Security, LLC for the U.S. Department of Energy/National Nuclear Security
+Administration. All rights in the program are reserved by Triad National
+Security, LLC, and the U.S. Department of Energy/National Nuclear Security
+Administration. The Government is granted for itself and others acting on its
+behalf a nonexclusive, paid-up, irrevocable worldwide license in this material 
+to reproduce, prepare derivative works, distribute copies to the public, perform
+ publicly and display publicly, and to permit others to do so.
+------------------------------------------------------------------------- */
+
+#include "math.h"
+#include "stdio.h"
+#include "string.h"
+#include "core_sinsq.h"
+#include "app.h"
+#include "fft.h"
+#include "material.h"
+
+using namespace PFDD_NS;
+
+enum{BCC_PERFECT,USFE_ANGLE_TAU,MPEA};
+
+/* ---------------------------------------------------------------------- */
+
+CoreSinSq::CoreSinSq(PFDD_C *pfdd_p, int narg, char **arg) :
+  CoreEnergy(pfdd_p,narg,arg)
+{
+  if (strcmp(style,"bcc_perfect") == 0) model = BCC_PERFECT;
+  else if (strcmp(style,"usfe_angle_tau") == 0) model = USFE_ANGLE_TAU;
+  else model = MPEA;
+
+  // A_mpea is given on the global grid the run was set up with
+
+  if (model == MPEA) grid_data = 1;
+  An = 0.0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void CoreSinSq::init()
+{
+  Material *material = fft->material;
+  norm = material->mu*material->dslip*material->b;
+
+  // the amplitude depends on the line character
+
+  if (model == BCC_PERFECT) fft->theta_flag = 1;
+}
+
+/* ----------------------------------------------------------------------
+   The stress-state dependet USFE magnitude: USFE(MRSSP angle X, shear
+   stress tau), added by Hyojung 12/2020
+------------------------------------------------------------------------- */
+
+void CoreSinSq::setup()
+{
+  if (model != USFE_ANGLE_TAU) return;
+
+  Material *material = fft->material;
+  double **sigma_rot = fft->sigma_rot;
+  double mu = material->mu;
+  double angle_to_110 = app->angle_to_110;
+
+  double gsfe_max = (material->a_slope*sigma_rot[2][1]*mu*1.0E-9+material->a_b)*sin(material->b_b*angle_to_110*M_PI/180.)+(material->c_slope*sigma_rot[2][1]*mu*1.0E-9+material->c_b) ;
+  gsfe_max = gsfe_max*1.0E-3;  // unit: mJ/m^2 to J/m^
+  An = gsfe_max/norm;
+
+  if (me == 0) {
+    if (logfile) fprintf(logfile,"core flag=6, usfe(angle,tau): %lf\n", gsfe_max);
+    if (logfile) fprintf(logfile,"sigma: %lf, angle_to_110: %lf\n", sigma_rot[1][2], angle_to_110);
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+double CoreSinSq::tile(int lo, int hi)
+{
+  if (model == BCC_PERFECT) return sites<BCC_PERFECT>(lo,hi);
+  if (model == USFE_ANGLE_TAU) return sites<USFE_ANGLE_TAU>(lo,hi);
+  return sites<MPEA>(lo,hi);
+}
+
+/* ----------------------------------------------------------------------
+   amplitude A of each site from the line character, the resolved stress
+   or the global grid of A_mpea, which the slab indexes from its i,j,k
+------------------------------------------------------------------------- */
+
+template <int MODEL>
+double CoreSinSq::sites(int lo, int hi)
+{
+  int NS = fft->slip_systems;
+  int N2 = fft->local_y;
+  int N3 = fft->local_z;
+  int nsite = fft->local_x*N2*N3;
+  int ny = fft->ny, nz = fft->nz;
+  const double *x = fft->xi[0];
+  const double *theta = fft->theta;
+  double *dE_core = fft->dE_core;
+  double usf = fft->material->usf/norm;
+  double esum = 0.0;
+  double A = An;
+
+  for (int isa = 0; isa < NS; isa++) {
+    int offset = isa*nsite;
+    const double *A_mpea = NULL;
+    int i = 0, j = 0, k = 0, row = 0;
+
+    if (MODEL == MPEA) {
+      A_mpea = fft->material->A_mpea + isa*fft->nx*ny*nz;
+      i = lo/(N2*N3);
+      j = (lo/N3) % N2;
+      k = lo % N3;
+      row = ((fft->local_x_start+i)*ny + fft->local_y_start+j)*nz +
+        fft->local_z_start;
+    }
+
+    for (int m = offset+lo; m < offset+hi; m++) {
+      if (MODEL == BCC_PERFECT) {
+        double t = theta[m];
+        double cof;
+        if (t < 0.0) cof = 1.0;
+        else if (t < 1.23) cof = 1.1603*t*t - 2.0431*t + 1;
+        else cof = 0.5473*t*t - 2.0035*t + 1.8923;
+        A = usf*cof;
+      }
+      else if (MODEL == MPEA) {
+        A = A_mpea[row+k]/norm;
+        if (++k == N3) {
+          k = 0;
+          if (++j == N2) {
+            j = 0;
+            i++;
+          }
+          row = ((fft->local_x_start+i)*ny + fft->local_y_start+j)*nz +
+            fft->local_z_start;
+        }
+      }
+
+      double s = sin(M_PI*x[2*m]);
+      esum += A*s*s;
+      dE_core[m] = A*M_PI*sin(2.0*M_PI*x[2*m]);
+    }
+  }
+
+  return esum;
+}
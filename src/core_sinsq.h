@@ -0,0 +1,52 @@
+/* ----------------------------------------------------------------------
+PFDD -- Phase Field Dislocation Dynamics
+
+© 2022. Triad National Security, LLC. All rights reserved.
+This program was produced under U.S. Government contract 89233218CNA000001 for
+Los Alamos National Laboratory (LANL), which is operated by Triad National
+Security, LLC for the U.S. Department of Energy/National Nuclear Security
+Administration. All rights in the program are reserved by Triad National
+Security, LLC, and the U.S. Department of Energy/National Nuclear Security
+Administration. The Government is granted for itself and others acting on its
+behalf a nonexclusive, paid-up, irrevocable worldwide license in this material 
+to reproduce, prepare derivative works, distribute copies to the public, perform
+ publicly and display publicly, and to permit others to do so.
+------------------------------------------------------------------------- */
+
+#ifdef CORE_CLASS
+CoreStyle(bcc_perfect,CoreSinSq)
+CoreStyle(usfe_angle_tau,CoreSinSq)
+CoreStyle(mpea,CoreSinSq)
+
+#else
+
+#ifndef PFDD_CORE_SINSQ_H
+#define PFDD_CORE_SINSQ_H
+
+#include "core_energy.h"
+
+namespace PFDD_NS {
+
+// An sin^2(pi xi) with an amplitude that varies with the dislocation
+// character (bcc_perfect), the resolved stress (usfe_angle_tau) or
+// from site to site of the input grid (mpea)
+
+class CoreSinSq : public CoreEnergy {
+ public:
+  CoreSinSq(class PFDD_C *, int, char **);
+  void init();
+  void setup();
+  double tile(int, int);
+
+ private:
+  int model;                  // BCC_PERFECT, USFE_ANGLE_TAU or MPEA
+  double norm;                // mu dslip b
+  double An;                  // amplitude of usfe_angle_tau, over norm
+
+  template <int MODEL> double sites(int, int);
+};
+
+}
+
+#endif
+#endif
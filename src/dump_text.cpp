@@ -171,6 +171,11 @@ void DumpText::init_style()
   // if (flag && !fft)
   //   error->all(FLERR,"Dump requires propensity but no KMC solve performed");
 
+  // theta is only kept by the solver when something reads it
+
+  for (int i = 0; i < size_one; i++)
+    if (pack_choice[i] == &DumpText::pack_theta) fft->theta_flag = 1;
+
   // set index and check validity of region
 
   if (iregion >= 0) {
@@ -18,6 +18,7 @@ to reproduce, prepare derivative works, distribute copies to the public, perform
 #include <stdio.h>
 #include "stdlib.h"
 #include "string.h"
+#include "ctype.h"
 #include "fft.h"
 #include "app.h"
 #include "lattice.h"
@@ -46,16 +47,30 @@ FFT::FFT(PFDD_C *pfdd_p, int narg, char **arg) : Pointers(pfdd_p)
   periodicity[2] = zperiodic;
 
   nx = ny = nz = 0;
+  hgrid = 1.0;
+  check_norm = 1;
+  xinorm = xiave = ximin = 0.0;
   norder = 1;
+  plan_effort = 0;
+  wisdom_file = NULL;
+  r2c = 0;
+  grad_spectral = 0;
+  plan_hits = plan_misses = 0;
+  nglide = glide_auto = 0;
+  matrix_free = 0;
+  glide_plane = NULL;
+  local_y_start = local_z_start = 0;
+  kspace_transposed = 0;
+  local_kn1 = local_kn2 = 0;
   xi = NULL;
   xi_sum = NULL;
 
   fx = fy = fz = NULL;
   f = r = NULL;
-  BB = FF = DD = NULL;
+  BB = FF = NULL;
   //Grad
-  gradx = grady = gradz = NULL;
   theta = NULL;
+  theta_flag = 0;
 
   fcore = df1core = df2core = df3core = dE_core = NULL;
   data_sigma = tau = NULL;
@@ -139,6 +154,59 @@ FFT::FFT(PFDD_C *pfdd_p, int narg, char **arg) : Pointers(pfdd_p)
       mode = atoi(arg[iarg]);
       iarg += 1;
     }
+    else if (strcmp(arg[iarg],"plan") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal fft_style command");
+      if (strcmp(arg[iarg+1],"estimate") == 0) plan_effort = 0;
+      else if (strcmp(arg[iarg+1],"measure") == 0) plan_effort = 1;
+      else if (strcmp(arg[iarg+1],"patient") == 0) plan_effort = 2;
+      else error->all(FLERR,"Illegal fft_style command");
+      iarg += 2;
+    }
+    else if (strcmp(arg[iarg],"r2c") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal fft_style command");
+      if (strcmp(arg[iarg+1],"yes") == 0) r2c = 1;
+      else if (strcmp(arg[iarg+1],"no") == 0) r2c = 0;
+      else error->all(FLERR,"Illegal fft_style command");
+      iarg += 2;
+    }
+    else if (strcmp(arg[iarg],"gradient") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal fft_style command");
+      if (strcmp(arg[iarg+1],"stencil") == 0) grad_spectral = 0;
+      else if (strcmp(arg[iarg+1],"spectral") == 0) grad_spectral = 1;
+      else error->all(FLERR,"Illegal fft_style command");
+      iarg += 2;
+    }
+    else if (strcmp(arg[iarg],"matrix_free") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal fft_style command");
+      if (strcmp(arg[iarg+1],"yes") == 0) matrix_free = 1;
+      else if (strcmp(arg[iarg+1],"no") == 0) matrix_free = 0;
+      else error->all(FLERR,"Illegal fft_style command");
+      iarg += 2;
+    }
+    else if (strcmp(arg[iarg],"glide_planes") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal fft_style command");
+      iarg += 1;
+      if (strcmp(arg[iarg],"auto") == 0) {
+        glide_auto = 1;
+        iarg += 1;
+      }
+      else {
+        while (iarg < narg && isdigit(arg[iarg][0])) {
+          memory->grow(glide_plane,nglide+1,"fft:glide_plane");
+          glide_plane[nglide++] = atoi(arg[iarg]);
+          iarg += 1;
+        }
+        if (nglide == 0) error->all(FLERR,"Illegal fft_style command");
+      }
+    }
+    else if (strcmp(arg[iarg],"wisdom") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal fft_style command");
+      delete [] wisdom_file;
+      int n = strlen(arg[iarg+1]) + 1;
+      wisdom_file = new char[n];
+      strcpy(wisdom_file,arg[iarg+1]);
+      iarg += 2;
+    }
     else error->all(FLERR,"Illegal fft_style command");
   }
 
@@ -168,6 +236,8 @@ FFT::~FFT()
   delete lattice;
   for (int i = 0; i < nregion; i++) delete regions[i];
   memory->sfree(regions);
+  delete [] wisdom_file;
+  memory->destroy(glide_plane);
 }
 
 /* ----------------------------------------------------------------------
@@ -324,9 +394,6 @@ void FFT::procs2domain_1d()
 
 void FFT::procs2domain_2d()
 {
-  int ipx,ipy;
-  double boxx,boxy,surf;
-
   if (user_procgrid[0] || user_procgrid[1] || user_procgrid[2]) {
     if (user_procgrid[2] != 1)
       error->all(FLERR,"App style proc count is not valid for 2d simulation");
@@ -334,27 +401,7 @@ void FFT::procs2domain_2d()
     procgrid[1] = user_procgrid[1];
 
   } else {
-
-    // loop thru all possible factorizations of nprocs
-    // surf = perimeter of a proc sub-domain
-
-    double bestsurf = 2.0 * (xprd+yprd);
-
-    ipx = 1;
-    while (ipx <= nprocs) {
-      if (nprocs % ipx == 0) {
-	ipy = nprocs/ipx;
-	boxx = xprd/ipx;
-	boxy = yprd/ipy;
-	surf = boxx + boxy;
-	if (surf < bestsurf) {
-	  bestsurf = surf;
-	  procgrid[0] = ipx;
-	  procgrid[1] = ipy;
-	}
-      }
-      ipx++;
-    }
+    procs2grid_2d(nprocs,xprd,yprd,procgrid[0],procgrid[1]);
   }
 
   procgrid[2] = 1;
@@ -377,6 +424,38 @@ void FFT::procs2domain_2d()
   subzhi = boxzhi;
 }
 
+/* ----------------------------------------------------------------------
+   factor n procs into a pa by pb grid over a 2d extent prda by prdb
+   so as to minimize the perimeter per proc
+------------------------------------------------------------------------- */
+
+void FFT::procs2grid_2d(int n, double prda, double prdb, int &pa, int &pb)
+{
+  int ia,ib;
+  double boxa,boxb,surf;
+
+  // loop thru all possible factorizations of n
+  // surf = perimeter of a proc sub-domain
+
+  double bestsurf = 2.0 * (prda+prdb);
+
+  ia = 1;
+  while (ia <= n) {
+    if (n % ia == 0) {
+      ib = n/ia;
+      boxa = prda/ia;
+      boxb = prdb/ib;
+      surf = boxa + boxb;
+      if (surf < bestsurf) {
+	bestsurf = surf;
+	pa = ia;
+	pb = ib;
+      }
+    }
+    ia++;
+  }
+}
+
 /* ----------------------------------------------------------------------
    assign nprocs to 3d box so as to minimize surface area per proc
 ------------------------------------------------------------------------- */
@@ -42,6 +42,14 @@ namespace PFDD_NS {
     int nx,ny,nz;               // mesh dimensions
     // only set for periodic sites from create_sites
     int mode;                   // Flag for the way the data is organized for the fft calculation
+    int plan_effort;            // FFTW planner effort: 0 = estimate, 1 = measure, 2 = patient
+    char *wisdom_file;          // FFTW wisdom file loaded before and saved after planning
+    int r2c;                    // 1 = real xi, real-to-complex transforms on a half spectrum
+    int plan_hits,plan_misses;  // FFT plan cache lookups that found or made a plan
+    int matrix_free;            // 1 = BB and FF evaluated per k-point, not stored
+    int nglide;                 // # of z glide planes xi is confined to, 0 = no confinement
+    int *glide_plane;           // z index of each glide plane
+    int glide_auto;             // 1 = glide planes are the z planes where xi starts nonzero
     int norder;                 // # of order parameters
     double **xi;             // order parameter for the phase field (xi)
     double **xi_sum;             // order parameter for the phase field NOT CLEAR (xi_sum)
@@ -49,7 +57,9 @@ namespace PFDD_NS {
     double xinorm;              // norm of the change in xi
     double ximin;               //minimum order parameter in the slip plane i == 0
     double xiave;               // Average order parameter
+    int check_norm;             // 0 = xinorm and xiave not reduced this step
     double obsden;              // obstacle density
+    double hgrid;               // grid spacing in input grid cells, > 1 on a coarse level
 
     double *fx;                  // 1D array with all the frequencies in x
     double *fy;                  // 1D array with all the frequencies in y
@@ -59,17 +69,14 @@ namespace PFDD_NS {
 
     double ****C;               // stiffness matrix
     //double *****G;                 // green's function for each Fourier point
-    double *BB;                 // Green's function
+    double *BB;                 // slip interaction kernel, pairs ka <= kb only
     double *FF;                 // Green's function
-    double *DD;                 // Green's function
     //Grad
-    double *gradx;              // gradient on x of xi
-    double *grady;              // gradient on y of xi
-    double *gradz;              // gradient on z of xi
-    double *theta;              // line character angle
+    double *theta;              // line character angle, per slip system
+    int theta_flag;             // 1 if the core energy or a dump reads theta
+    int grad_spectral;          // 1 = theta from the spectrum of xi, 0 = stencil
 
     double *fcore;              // 1D array for the gamma surface
-    double *f_core;              // 1D array for the gamma surface. Added for MPI in extended core energy by CLaire 7/31/18
     double *df1core;            // derivative of the gamma surface in 1
     double *df2core;            // derivative of the gamma surface in 2
     double *df3core;            // derivative of the gamma surface in 3
@@ -114,6 +121,12 @@ namespace PFDD_NS {
     // you must allocate for your local data
     int local_y;                // # of local grid points in y
     int local_z;                // # of local grid points in z
+    int local_y_start;          // id of starting local y plane, 0 for slabs
+    int local_z_start;          // id of starting local z plane, 0 for slabs
+    int local_kz;               // # of local frequencies in z, local_z/2+1 with r2c
+    int kspace_transposed;      // 1 = k-space in FFTW transposed order, y outermost
+    int local_kn1,local_kn2;    // local k-space extents of the two outer stored dims,
+                                // local_x,local_y or local_ny_after_trans,nx if transposed
 
     class Lattice *lattice;                  // user-defined lattice
     class Material *material;                  // user-defined material
@@ -135,7 +148,7 @@ namespace PFDD_NS {
     double cntf[3];                    // Center point in rotated space
 
     FFT(class PFDD_C *, int, char **);
-    ~FFT();
+    virtual ~FFT();
 
     void set_box();
     void set_lattice(int, char **);
@@ -146,7 +159,8 @@ namespace PFDD_NS {
 
     void procs2domain_1d();
     void procs2domain_2d();
-    void procs2domain_3d();
+    virtual void procs2domain_3d();
+    void procs2grid_2d(int, double, double, int &, int &);
 
     virtual void create_plan() = 0;
     virtual void init() = 0;
@@ -155,8 +169,18 @@ namespace PFDD_NS {
     virtual void stiffness() = 0;
     virtual void greens_function() = 0;
     virtual void internal_energy() = 0;
-    virtual void update_order_parameter() = 0;
+    virtual void update_order_parameter(double) = 0;
     virtual void prepare_next_itr() = 0;
+    virtual void prepare_semi_implicit(double, double) = 0;
+    virtual void implicit_solve(double, double) = 0;
+    virtual void update_order_parameter_implicit() = 0;
+    virtual void xi_force(double *) = 0;
+    virtual void mobile_sites(double *) = 0;
+    virtual void regrid(int, int, int) = 0;
+    virtual void restrict_xi(int) = 0;
+    virtual void load_xi() = 0;
+    virtual void spectrum_xi() = 0;
+    virtual void prolongate_xi(int, int, int) = 0;
     virtual void temp_stor_data() = 0;
     virtual void reset_data() = 0;
     virtual void Bmatrix() = 0;
@@ -190,13 +214,7 @@ namespace PFDD_NS {
 
 
     virtual void gradient()= 0; //Grad
-    virtual void core_energy_bcc_perfect() = 0;
-    virtual void core_energy_perfect() = 0;
-    virtual void core_energy_extended() = 0;
-    virtual void core_energy_sine() = 0;
-    virtual void core_energy_pyrII() = 0;//Claire changed 8/1/18: was core_energy_isf_usf
-    virtual void core_energy_USFE_angle_tau() =0; //added HJ
-    virtual void core_energy_mpea() = 0;
+    virtual void sweep() = 0;
     virtual void project_core_energy() = 0;
 
     virtual void init_loop() = 0;
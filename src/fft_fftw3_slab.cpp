@@ -0,0 +1,246 @@
+/* ----------------------------------------------------------------------
+PFDD -- Phase Field Dislocation Dynamics
+
+© 2022. Triad National Security, LLC. All rights reserved.
+This program was produced under U.S. Government contract 89233218CNA000001 for
+Los Alamos National Laboratory (LANL), which is operated by Triad National
+Security, LLC for the U.S. Department of Energy/National Nuclear Security
+Administration. All rights in the program are reserved by Triad National
+Security, LLC, and the U.S. Department of Energy/National Nuclear Security
+Administration. The Government is granted for itself and others acting on its
+behalf a nonexclusive, paid-up, irrevocable worldwide license in this material 
+to reproduce, prepare derivative works, distribute copies to the public, perform
+ publicly and display publicly, and to permit others to do so.
+   ------------------------------------------------------------------------- */
+
+#ifdef FFT_FFTW3
+
+#include "math.h"
+#include "mpi.h"
+#include "string.h"
+#include "fft_fftw3_slab.h"
+#include "app.h"
+#include "memory.h"
+#include "error.h"
+
+using namespace PFDD_NS;
+
+/* ---------------------------------------------------------------------- */
+
+FFTW3_Slab::FFTW3_Slab(PFDD_C *pfdd_p, int narg, char **arg) :
+  FFTW_Slab(pfdd_p,narg,arg)
+{
+  fftw_mpi_init();
+
+  plan = iplan = gplan = NULL;
+}
+
+/* ---------------------------------------------------------------------- */
+
+FFTW3_Slab::~FFTW3_Slab()
+{
+  // plan, iplan and gplan belong to the plan cache of FFTW_Slab
+}
+
+/* ----------------------------------------------------------------------
+initialize fftw
+sizes come from FFTW before allocation, plans are made on the allocated
+arrays since measured planning needs real buffers to time
+------------------------------------------------------------------------- */
+
+void FFTW3_Slab::init()
+{
+  stress_inc = app->stoptime;
+  dimension = app->dimension;
+  sigma = app->sigma;
+  deltasig = app->deltasig;
+
+  /* slab decomposition */
+
+  // r2c sizes are counted in complex elements of the half spectrum
+
+  local_kz = r2c ? nz/2+1 : nz;
+
+  ptrdiff_t lnx, lxs, lny, lys;
+  ptrdiff_t alloc_local = fftw_mpi_local_size_3d_transposed(nx, ny, local_kz,
+    world, &lnx, &lxs, &lny, &lys);
+
+  local_x = static_cast<int>(lnx);
+  local_x_start = static_cast<int>(lxs);
+  local_ny_after_trans = static_cast<int>(lny);
+  local_y_start_after_trans = static_cast<int>(lys);
+  total_local_size = static_cast<int>(alloc_local);
+
+  local_y = ny;
+  local_z = nz;
+
+  // allocate arrays
+  allocate();
+
+  create_plan();
+
+  box_extremes();
+}
+
+/* ----------------------------------------------------------------------
+create plan and iplan for fftw
+single slip system plans work in place on work, mode 2 adds the 1d
+plans of the batched transform, see FFTW_Slab::batch_setup(), and
+gradient spectral the backward plan of the 3 gradient components
+------------------------------------------------------------------------- */
+
+void FFTW3_Slab::create_plan()
+{
+  unsigned flags = FFTW_ESTIMATE;
+  if (plan_effort == 1) flags = FFTW_MEASURE;
+  else if (plan_effort == 2) flags = FFTW_PATIENT;
+
+  if (wisdom_file) load_wisdom();
+
+  int kind = r2c ? PLAN_R2C : PLAN_C2C;
+  plan = mpi_plan(kind, FFTW_FORWARD, flags);
+  iplan = mpi_plan(kind, FFTW_BACKWARD, flags);
+  if (grad_spectral) gplan = mpi_plan(kind, FFTW_BACKWARD, flags, 3);
+
+  if (mode == 2) batch_setup();
+
+  if (wisdom_file) save_wisdom();
+}
+
+/* ----------------------------------------------------------------------
+distributed plan of the whole grid in place on work, made once and then
+found in the plan cache; with r2c forward is r2c and backward c2r
+nf fields are interleaved, work holds 3 for gradient spectral
+------------------------------------------------------------------------- */
+
+fftw_plan FFTW3_Slab::mpi_plan(int kind, int dir, unsigned flags, int nf)
+{
+  int n[3] = {nx, ny, nz};
+  ptrdiff_t nn[3] = {nx, ny, nz};
+  fftw_plan p = (fftw_plan) find_plan(kind, n, dir, nf, 0, 0);
+  if (p) return p;
+
+  fftw_complex *wk = reinterpret_cast<fftw_complex *>(work);
+  double *rwk = reinterpret_cast<double *>(work);
+
+  // transposed k-space: forward output and backward input are y slabs
+  if (kspace_transposed)
+    flags |= (dir == FFTW_FORWARD) ? FFTW_MPI_TRANSPOSED_OUT : FFTW_MPI_TRANSPOSED_IN;
+
+  if (kind == PLAN_C2C)
+    p = fftw_mpi_plan_many_dft(3, nn, nf, FFTW_MPI_DEFAULT_BLOCK,
+      FFTW_MPI_DEFAULT_BLOCK, wk, wk, world, dir, flags);
+  else if (dir == FFTW_FORWARD)
+    p = fftw_mpi_plan_many_dft_r2c(3, nn, nf, FFTW_MPI_DEFAULT_BLOCK,
+      FFTW_MPI_DEFAULT_BLOCK, rwk, wk, world, flags);
+  else
+    p = fftw_mpi_plan_many_dft_c2r(3, nn, nf, FFTW_MPI_DEFAULT_BLOCK,
+      FFTW_MPI_DEFAULT_BLOCK, wk, rwk, world, flags);
+  if (p == NULL) error->all(FLERR,"FFTW3 plan could not be created");
+
+  add_plan(kind, n, dir, nf, 0, 0, p);
+  return p;
+}
+
+/* ----------------------------------------------------------------------
+proc 0 reads the wisdom file and shares it with all procs
+------------------------------------------------------------------------- */
+
+void FFTW3_Slab::load_wisdom()
+{
+  int flag = 0;
+  if (me == 0) flag = fftw_import_wisdom_from_filename(wisdom_file);
+  MPI_Bcast(&flag,1,MPI_INT,0,world);
+  if (flag == 0) {
+    if (me == 0) error->warning(FLERR,"No usable FFTW wisdom in file, planning from scratch");
+    return;
+  }
+  fftw_mpi_broadcast_wisdom(world);
+}
+
+/* ----------------------------------------------------------------------
+collect the wisdom of all procs on proc 0 and write it out
+------------------------------------------------------------------------- */
+
+void FFTW3_Slab::save_wisdom()
+{
+  fftw_mpi_gather_wisdom(world);
+  if (me == 0 && fftw_export_wisdom_to_filename(wisdom_file) == 0)
+    error->warning(FLERR,"Could not write FFTW wisdom file");
+}
+
+/* -----------------------------------------------------------------------
+execute a plan of nf fields in place on slot, one total_local_size slot
+per field, as large as the scratch FFTW asked for in init()
+FFTW only runs a plan on arrays aligned like work, which it was made
+on, and malloc does not promise that: a slot aligned otherwise goes
+through work
+---------------------------------------------------------------------*/
+void FFTW3_Slab::execute(fftw_plan p, int dir, FFT_DATA *slot, int nf)
+{
+  FFT_DATA *data = slot;
+  size_t nbytes = static_cast<size_t>(nf)*total_local_size*sizeof(FFT_DATA);
+
+  if (fftw_alignment_of(reinterpret_cast<double *>(slot)) !=
+      fftw_alignment_of(reinterpret_cast<double *>(work))) {
+    memcpy(work, slot, nbytes);
+    data = work;
+  }
+
+  fftw_complex *c = reinterpret_cast<fftw_complex *>(data);
+  double *r = reinterpret_cast<double *>(data);
+
+  if (!r2c) fftw_mpi_execute_dft(p, c, c);
+  else if (dir == FFTW_FORWARD) fftw_mpi_execute_dft_r2c(p, r, c);
+  else fftw_mpi_execute_dft_c2r(p, c, r);
+
+  if (data != slot) memcpy(slot, work, nbytes);
+}
+
+/* -----------------------------------------------------------------------
+forward FFT
+with r2c each system holds padded real rows in and a half spectrum out,
+on more than one proc the spectrum is in transposed order
+---------------------------------------------------------------------*/
+void FFTW3_Slab::forward_mode1()
+{
+  int NS = slip_systems;
+
+  for(int i=0; i<NS; i++)
+    execute(plan, FFTW_FORWARD, data_fftw+i*total_local_size);
+}
+
+/* -----------------------------------------------------------------------
+backward FFT
+---------------------------------------------------------------------*/
+void FFTW3_Slab::backward_mode1()
+{
+  int NS = slip_systems;
+
+  for(int i=0; i<NS; i++)
+    execute(iplan, FFTW_BACKWARD, data_real+i*total_local_size);
+}
+
+/* -----------------------------------------------------------------------
+inverse FFT of the ND*ND displacement gradient components in data_strain
+reuses the backward plan instead of planning on every call
+---------------------------------------------------------------------*/
+void FFTW3_Slab::backward_strain()
+{
+  int ND = dimension;
+  int SK = strain_stride;
+
+  for(int i=0;i<ND*ND;i++)
+    execute(iplan, FFTW_BACKWARD, data_strain+i*SK);
+}
+
+/* -----------------------------------------------------------------------
+inverse FFT of the 3 components of grad(xi) in data_grad, interleaved
+fields of one plan
+---------------------------------------------------------------------*/
+void FFTW3_Slab::backward_gradient()
+{
+  execute(gplan, FFTW_BACKWARD, data_grad, 3);
+}
+
+#endif
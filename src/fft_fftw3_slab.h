@@ -0,0 +1,83 @@
+/* ----------------------------------------------------------------------
+PFDD -- Phase Field Dislocation Dynamics
+
+© 2022. Triad National Security, LLC. All rights reserved.
+This program was produced under U.S. Government contract 89233218CNA000001 for
+Los Alamos National Laboratory (LANL), which is operated by Triad National
+Security, LLC for the U.S. Department of Energy/National Nuclear Security
+Administration. All rights in the program are reserved by Triad National
+Security, LLC, and the U.S. Department of Energy/National Nuclear Security
+Administration. The Government is granted for itself and others acting on its
+behalf a nonexclusive, paid-up, irrevocable worldwide license in this material 
+to reproduce, prepare derivative works, distribute copies to the public, perform
+ publicly and display publicly, and to permit others to do so.
+   ------------------------------------------------------------------------- */
+
+#ifdef FFT_FFTW3
+
+#ifdef FFT_CLASS
+FftStyle(fftw3_slab,FFTW3_Slab)
+
+#else
+
+#ifndef PFDD_FFT_FFTW3_SLAB_H
+#define PFDD_FFT_FFTW3_SLAB_H
+
+#include "fft_fftw_slab.h"
+
+namespace PFDD_NS {
+
+  // same slab decomposition and physics as FFTW_Slab, transforms done
+  // with the FFTW 3 MPI interface so plans can be measured and their
+  // wisdom kept between runs
+
+  class FFTW3_Slab : public FFTW_Slab {
+  public:
+
+    fftw_plan plan, iplan;            // one slip system, in place on any slot
+    fftw_plan gplan;                  // backward, 3 interleaved gradient fields
+
+    FFTW3_Slab(class PFDD_C *, int, char **);
+    ~FFTW3_Slab();
+
+    void create_plan();
+    void init();
+    void forward_mode1();
+    void backward_mode1();
+    void backward_strain();
+    void backward_gradient();
+
+  private:
+    fftw_plan mpi_plan(int, int, unsigned, int nf = 1);
+    void execute(fftw_plan, int, FFT_DATA *, int nf = 1);
+    void load_wisdom();
+    void save_wisdom();
+  };
+
+}
+
+#endif
+#endif
+#endif
+
+/* ERROR/WARNING messages:
+
+   E: Illegal fft_style command
+
+   Self-explanatory.  Check the input script syntax and compare to the
+   documentation for the command.
+
+   E: FFTW3 plan could not be created
+
+   FFTW returned a NULL plan for the requested grid and planner effort.
+
+   W: No usable FFTW wisdom in file, planning from scratch
+
+   The wisdom file does not exist yet or was written for another grid,
+   FFTW version or machine.  It is rewritten after planning.
+
+   W: Could not write FFTW wisdom file
+
+   The plans are still valid, only the wisdom is not kept for the next run.
+
+*/
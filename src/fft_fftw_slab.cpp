@@ -21,14 +21,22 @@ to reproduce, prepare derivative works, distribute copies to the public, perform
 #include "lattice.h"
 #include "memory.h"
 #include "error.h"
-#include "dfftw_mpi.h"
 #include "material.h"
 #include "solve.h"
+#include "core_energy.h"
 
 using namespace PFDD_NS;
 
 #define DELTA(i, j)   ((i==j) ? 1 : 0)
 
+// BB is symmetric in the slip systems, only ka <= kb is stored, pair
+// PAIR(ka,kb,NS) of the NS*(NS+1)/2 packed pairs
+#define PAIR(a, b, n) ((a)*(n) - (a)*((a)-1)/2 + (b)-(a))
+
+// k-points of internal_energy() handled together, sized so the tile of
+// every slip system stays in cache
+#define KBLOCK 128
+
 /* ---------------------------------------------------------------------- */
 
 FFTW_Slab::FFTW_Slab(PFDD_C *pfdd_p, int narg, char **arg) : FFT(pfdd_p,narg,arg)
@@ -36,15 +44,71 @@ FFTW_Slab::FFTW_Slab(PFDD_C *pfdd_p, int narg, char **arg) : FFT(pfdd_p,narg,arg
 
   user_procgrid[0] = nprocs;
   user_procgrid[1] = user_procgrid[2] = 1;
+
+  if (r2c && mode == 2) error->all(FLERR,"fft_style r2c requires mode 1");
+
+  sendbuf = recvbuf = NULL;
+  for (int i = 0; i < 2; i++) xplan[i] = yplan[i] = zplan[i] = NULL;
+  xy.np = yx.np = 0;
+
+  if (r2c && (nglide || glide_auto))
+    error->all(FLERR,"fft_style glide_planes requires r2c no");
+  pbuf = ztwiddle = NULL;
+  bb_e = bb_s = NULL;
+  bbt = ffk = NULL;
+  chol = NULL;
+  skin = dskin = NULL;
+  nskin_req = ndskin_req = 0;
+  data_grad = NULL;
+  gsin = NULL;
+  spectrum_ready = 0;
+  lvl_buf = NULL;
+  zactive = NULL;
+  pxy.np = pyx.np = 0;
+  psize = 0;
+
+  nplans = maxplans = 0;
+  plans = NULL;
+
+  // FFTW batches fields at adjacent addresses, the pencil transform
+  // takes them total_local_size apart
+  grad_interleaved = 1;
+
+  // FFTW slabs leave k-space transposed, y slabs, when that saves a
+  // global transpose after every forward and before every backward FFT
+  kspace_transposed = (nprocs > 1);
 }
 
 /* ---------------------------------------------------------------------- */
 
 FFTW_Slab::~FFTW_Slab()
 {
-
+  destroy_plans();
+  remap_destroy(xy);
+  remap_destroy(yx);
+  remap_destroy(pxy);
+  remap_destroy(pyx);
+
+  memory->destroy(pbuf);
+  memory->destroy(ztwiddle);
+  memory->destroy(zactive);
+  memory->destroy(bb_e);
+  memory->destroy(bb_s);
+  memory->destroy(bbt);
+  memory->destroy(ffk);
+  memory->destroy(chol);
+  skin_destroy();
+  memory->destroy(skin);
+  memory->destroy(dskin);
+  memory->destroy(data_grad);
+  memory->destroy(gsin);
+  memory->destroy(lvl_buf);
+  memory->destroy(sendbuf);
+  memory->destroy(recvbuf);
 }
 
+#ifndef FFT_FFTW3
+
 /* ----------------------------------------------------------------------
 initialize fftw
 ------------------------------------------------------------------------- */
@@ -63,16 +127,38 @@ void FFTW_Slab::init()
 
   /* slab decomposition */
 
+  if (r2c) {
+    // sizes come in fftw_real units, data arrays are counted in complex
+    rfftwnd_mpi_local_sizes(rplan, &local_x, &local_x_start,
+      &local_ny_after_trans, &local_y_start_after_trans,
+      &total_local_size);
+    total_local_size = (total_local_size+1)/2;
+  }
+  else
   fftwnd_mpi_local_sizes(plan, &local_x, &local_x_start,
     &local_ny_after_trans, &local_y_start_after_trans,
     &total_local_size);
 
     local_y = ny;
     local_z = nz;
+    local_kz = r2c ? nz/2+1 : nz;
 
     // allocate arrays
     allocate();
 
+    if (mode == 2) batch_setup();
+
+    box_extremes();
+  }
+
+#endif
+
+  /* ----------------------------------------------------------------------
+  extremes of the box in the rotated (Fourier) axes
+  ------------------------------------------------------------------------- */
+
+  void FFTW_Slab::box_extremes()
+  {
     // Check for box extremes
     double xt=0,yt=0,zt=0;
     boxxlof = boxxhif = 0;
@@ -116,23 +202,84 @@ void FFTW_Slab::init()
     greens_function();
     Bmatrix();
     Fmatrix();
+
+    if (nglide || glide_auto) glide_setup();
+
+    // initial configuration xi -> data_fftw
+    prepare_next_itr();
   }
   /* ----------------------------------------------------------------------
   setup global box
   assumes boxlo/hi are already set
   ------------------------------------------------------------------------- */
 
+#ifndef FFT_FFTW3
+
   void FFTW_Slab::create_plan()
   {
 
     /*create plan and iplan for fftw*/
 
-    plan = fftw3d_mpi_create_plan(world, nx, ny, nz, FFTW_FORWARD, FFTW_ESTIMATE);
+    if (wisdom_file && me == 0)
+      error->warning(FLERR,"FFT wisdom file requires fft_style fftw3_slab, ignored");
+
+    if (r2c) {
+      rplan = r2c_plan(FFTW_REAL_TO_COMPLEX);
+
+      riplan = r2c_plan(FFTW_COMPLEX_TO_REAL);
+      return;
+    }
+
+    plan = c2c_plan(FFTW_FORWARD);
+
+    iplan = c2c_plan(FFTW_BACKWARD);
+
+  }
+
+  /* ----------------------------------------------------------------------
+  distributed plans of the whole grid, made once and then found in the cache
+  FFTW 2 has no patient planner, measure is the best it offers
+  ------------------------------------------------------------------------- */
+
+  fftwnd_mpi_plan FFTW_Slab::c2c_plan(int dir)
+  {
+    // the backward transform of transposed k-space is planned with x and y
+    // swapped, see backward_mode1()
+
+    int n[3] = {nx, ny, nz};
+    if (kspace_transposed && dir == FFTW_BACKWARD) {
+      n[0] = ny;
+      n[1] = nx;
+    }
+    fftwnd_mpi_plan p = (fftwnd_mpi_plan) find_plan(PLAN_C2C,n,dir,1,0,0);
+    if (p) return p;
+
+    int flags = FFTW_ESTIMATE;
+    if (plan_effort > 0) flags = FFTW_MEASURE;
+    p = fftw3d_mpi_create_plan(world, n[0], n[1], n[2], (fftw_direction) dir, flags);
+    if (p == NULL) error->all(FLERR,"Could not create FFT plan");
+    add_plan(PLAN_C2C,n,dir,1,0,0,p);
+    return p;
+  }
 
-    iplan = fftw3d_mpi_create_plan(world, nx, ny, nz, FFTW_BACKWARD, FFTW_ESTIMATE);
+  /* ---------------------------------------------------------------------- */
 
+  rfftwnd_mpi_plan FFTW_Slab::r2c_plan(int dir)
+  {
+    int n[3] = {nx, ny, nz};
+    rfftwnd_mpi_plan p = (rfftwnd_mpi_plan) find_plan(PLAN_R2C,n,dir,1,0,0);
+    if (p) return p;
+
+    int flags = FFTW_ESTIMATE;
+    if (plan_effort > 0) flags = FFTW_MEASURE;
+    p = rfftw3d_mpi_create_plan(world, nx, ny, nz, (fftw_direction) dir, flags);
+    if (p == NULL) error->all(FLERR,"Could not create FFT plan");
+    add_plan(PLAN_R2C,n,dir,1,0,0,p);
+    return p;
   }
 
+#endif
+
   /* ----------------------------------------------------------------------
   allocate
   ------------------------------------------------------------------------- */
@@ -141,15 +288,32 @@ void FFTW_Slab::init()
   {
 
     slip_systems = app->slip_systems;
-    num_planes = app->num_planes;
+    // apps that do not set the planes have one per slip system
+    num_planes = app->num_planes > 0 ? app->num_planes : slip_systems;
     dimension = app->dimension;
+
+    // k-space block of this proc, see frec()
+    if (kspace_transposed) {
+      local_kn1 = local_ny_after_trans;
+      local_kn2 = nx;
+    }
+    else {
+      local_kn1 = local_x;
+      local_kn2 = local_y;
+    }
+
+    // data_fftw and data_real hold each slip system in a total_local_size
+    // slot, large enough for the real space and the k-space block
     memory->create(data_fftw,total_local_size*slip_systems,"data_fftw");
     memory->create(data_real,total_local_size*slip_systems,"data_real");
     memory->create(temp_data,total_local_size*slip_systems,"temp_data");
-    memory->create(work,total_local_size,"work");
+    // the three gradient components are transformed together through work
+    memory->create(work,grad_spectral ? 3*total_local_size : total_local_size,"work");
     memory->create(work_strain,total_local_size,"work_strain");
-    memory->create(data_core,total_local_size*slip_systems,"data_core");
-    memory->create(data_strain,total_local_size*dimension*dimension,"data_strain");
+    // each component is transformed in a total_local_size slot, then
+    // packed lN1*N2*N3 apart, see strain()
+    strain_stride = MAX(total_local_size,local_x*local_y*local_z);
+    memory->create(data_strain,strain_stride*dimension*dimension,"data_strain");
 
     memory->create(xi,norder,2.0*slip_systems*local_x*local_y*local_z,"xi");
     memory->create(xi_sum,norder,2.0*local_x*local_y*local_z,"xi_sum");
@@ -160,27 +324,44 @@ void FFTW_Slab::init()
       xi_sum[i][j] = 0.0;
     }
     memory->create(xo,slip_systems*local_x*local_y*local_z,"xo");
-    memory->create(fx,local_x*local_y*local_z,"fx");
-    memory->create(fy,local_x*local_y*local_z,"fy");
-    memory->create(fz,local_x*local_y*local_z,"fz");
+    memory->create(fx,local_kn1*local_kn2*local_kz,"fx");
+    memory->create(fy,local_kn1*local_kn2*local_kz,"fy");
+    memory->create(fz,local_kn1*local_kn2*local_kz,"fz");
     memory->create(f,slip_systems*local_x*local_y*local_z,"f");
     memory->create(r,dimension,"r");
     memory->create(C,dimension,dimension,dimension,dimension,"C");
     //memory->create(G,local_x,local_y,local_z,dimension,dimension,"G");
 
-    memory->create(BB,slip_systems*slip_systems*local_x*local_y*local_z,"BB");
-    memory->create(FF,slip_systems*total_local_size*dimension*dimension,"FF");
-    memory->create(DD,slip_systems*total_local_size*dimension*dimension,"DD");
+    // matrix_free keeps BB of one block and F of one k-point instead
+    if (matrix_free) {
+      memory->create(bbt,slip_systems*(slip_systems+1)/2*KBLOCK,"fft:bbt");
+      memory->create(ffk,slip_systems*dimension*dimension,"fft:ffk");
+    }
+    else {
+      memory->create(BB,slip_systems*(slip_systems+1)/2*local_kn1*local_kn2*local_kz,"BB");
+      memory->create(FF,slip_systems*dimension*dimension*local_kn1*local_kn2*local_kz,"FF");
+    }
+    memory->create(chol,slip_systems*(slip_systems+2),"fft:chol");
+    memory->create(skin,4*slip_systems*local_y*local_z,"skin");
+    memory->create(dskin,2*num_planes,"dskin");
+    skin_setup();
+    if (grad_spectral) {
+      int n[3] = {nx, ny, nz};
+      double twopi = 2.0*acos(-1.0);
+      memory->create(data_grad,3*total_local_size,"data_grad");
+      memory->create(gsin,nx+ny+nz,"fft:gsin");
+      double *s = gsin;
+      for (int d = 0; d < 3; d++) {
+        for (int k = 0; k < n[d]; k++)
+          s[k] = 2*k == n[d] ? 0.0 : sin(twopi*k/n[d]);
+        s += n[d];
+      }
+    }
 
-    //Grad allocation
-    memory->create(gradx,num_planes*local_x*local_y*local_z,"gradx");
-    memory->create(grady,num_planes*local_x*local_y*local_z,"grady");
-    memory->create(gradz,num_planes*local_x*local_y*local_z,"gradz");
     //theta -- angle between dislocation line tangent and Burges vector
-    memory->create(theta,num_planes*local_x*local_y*local_z,"theta");
+    memory->create(theta,slip_systems*local_x*local_y*local_z,"theta");
 
     memory->create(fcore,num_planes*local_x*local_y*local_z,"fcore");//Check what NP is!
-    memory->create(f_core,num_planes*local_x*local_y*local_z,"f_core"); // added for MPI in extended core energy by Claire 7/31/18
     memory->create(df1core,num_planes*local_x*local_y*local_z,"df1core");
     memory->create(df2core,num_planes*local_x*local_y*local_z,"df2core");
     memory->create(df3core,num_planes*local_x*local_y*local_z,"df3core");
@@ -210,6 +391,13 @@ void FFTW_Slab::init()
     memory->create(delta,num_planes*local_x*local_y*local_z,"delta");
     memory->create(ddelta,num_planes*local_x*local_y*local_z,"ddelta");
 
+    // sweep() does not clear what the core energy style and
+    // project_core_energy() leave unset, they start out zero here
+    for(int i=0; i<slip_systems*local_x*local_y*local_z; i++)
+      theta[i] = dE_core[i] = 0.0;
+    for(int i=0; i<num_planes*local_x*local_y*local_z; i++)
+      fcore[i] = df1core[i] = df2core[i] = df3core[i] = delta[i] = ddelta[i] = 0.0;
+
     for(int i=0; i<dimension; i++){
       for(int j=0; j<dimension; j++){
         local_sigma[i][j] = 0;
@@ -223,6 +411,106 @@ void FFTW_Slab::init()
       }
     }
   }
+  /* ----------------------------------------------------------------------
+  free what allocate() and the mode 2 setup made, before allocating
+  again for another grid
+  ------------------------------------------------------------------------- */
+
+  void FFTW_Slab::deallocate()
+  {
+    memory->destroy(data_fftw);
+    memory->destroy(data_real);
+    memory->destroy(temp_data);
+    memory->destroy(work);
+    memory->destroy(work_strain);
+    memory->destroy(data_strain);
+    memory->destroy(xi);
+    memory->destroy(xi_sum);
+    memory->destroy(xo);
+    memory->destroy(fx);
+    memory->destroy(fy);
+    memory->destroy(fz);
+    memory->destroy(f);
+    memory->destroy(r);
+    memory->destroy(C);
+    memory->destroy(BB);
+    memory->destroy(FF);
+    memory->destroy(bbt);
+    memory->destroy(ffk);
+    memory->destroy(chol);
+    skin_destroy();
+    memory->destroy(skin);
+    memory->destroy(dskin);
+    memory->destroy(data_grad);
+    memory->destroy(gsin);
+    memory->destroy(theta);
+    memory->destroy(fcore);
+    memory->destroy(df1core);
+    memory->destroy(df2core);
+    memory->destroy(df3core);
+    memory->destroy(dE_core);
+    memory->destroy(xn);
+    memory->destroy(xb);
+    memory->destroy(data_sigma);
+    memory->destroy(tau);
+    memory->destroy(sigma_rot);
+    memory->destroy(local_sigma);
+    memory->destroy(ave_sigma);
+    memory->destroy(eps);
+    memory->destroy(data_eps);
+    memory->destroy(data_epsd);
+    memory->destroy(avepsd);
+    memory->destroy(ave_epsd);
+    memory->destroy(ave_eps);
+    memory->destroy(avepst);
+    memory->destroy(avepsts);
+    memory->destroy(aveps);
+    memory->destroy(delta);
+    memory->destroy(ddelta);
+    BB = NULL;
+    bbt = ffk = chol = NULL;
+
+    memory->destroy(sendbuf);
+    memory->destroy(recvbuf);
+    sendbuf = recvbuf = NULL;
+    remap_destroy(xy);
+    remap_destroy(yx);
+
+    // FFTW 3 plans are bound to the arrays they were made on
+    destroy_plans();
+  }
+
+  /* ----------------------------------------------------------------------
+  make the arrays and plans of an n1 x n2 x n3 grid of the same box, the
+  slip systems are kept, xi and xo are left zero and setup() has to be
+  called again; plans are made again for the new arrays
+  ------------------------------------------------------------------------- */
+
+  void FFTW_Slab::regrid(int n1, int n2, int n3)
+  {
+    int NS = slip_systems;
+    int ND = dimension;
+    double xnb[2*NS*ND];
+
+    for (int is = 0; is < NS; is++)
+      for (int i = 0; i < ND; i++) {
+        xnb[is*ND + i] = xn[is][i];
+        xnb[(NS+is)*ND + i] = xb[is][i];
+      }
+
+    deallocate();
+    nx = n1;
+    ny = n2;
+    nz = n3;
+    init();
+
+    for (int is = 0; is < NS; is++)
+      for (int i = 0; i < ND; i++) {
+        xn[is][i] = xnb[is*ND + i];
+        xb[is][i] = xnb[(NS+is)*ND + i];
+      }
+  }
+
   /* ----------------------------------------------------------------------
   Calculate sigma_rot
   ------------------------------------------------------------------------- */
@@ -273,13 +561,19 @@ void FFTW_Slab::init()
     d1 = d2 = d3 = 1.0;
     double kxnorm = 0.0;
 
-    for(i=0; i<local_x; i++){
-      for(j=0; j<ny; j++){
-        for(k=0; k<nz; k++){
-          nf = k+(j)*nz+(i)*nz*ny;
-          kx = local_x_start+i;
-          ky = j;
-          kz = k;
+    for(i=0; i<local_kn1; i++){
+      for(j=0; j<local_kn2; j++){
+        for(k=0; k<local_kz; k++){
+          nf = k+(j)*local_kz+(i)*local_kz*local_kn2;
+          if (kspace_transposed) {
+            kx = j;
+            ky = local_y_start_after_trans+i;
+          }
+          else {
+            kx = local_x_start+i;
+            ky = local_y_start+j;
+          }
+          kz = local_z_start+k;
           /* frecuency in x */
           // if (kx >= nx/2) kx = kx - nx;
           if (kx >= nx/2) {
@@ -453,19 +747,11 @@ generate BB matrix
 
 void FFTW_Slab::Bmatrix()
 {
-  int i, j, k, l, m, n, u, v, k1, k2, k3, ka, kb, nv, nb, nfreq;
-  int is, js, ks;
-  double fkr;
+  int i, j, k;
   //double C[dimension][dimension][dimension][dimension];
   //double Crot[dimension][dimension][dimension][dimension];
-  double A[dimension][dimension][dimension][dimension];
-
-  double B[slip_systems][slip_systems][local_x][local_y][local_z];
-  double G[dimension][dimension];
-  //double Grot[dimension][dimension];
-  double fk[dimension];
   double xn_temp[slip_systems][dimension], xb_temp[slip_systems][dimension], eps_temp[slip_systems][dimension][dimension];
-  double xnu, fk2, fk4, fka, fkb, ll, mu, young;
+  double xnu, ll, mu, young;
   double C44 = material->C44;
   double C12 = material->C12;
   double C11 = material->C11;
@@ -488,15 +774,6 @@ void FFTW_Slab::Bmatrix()
     printf("Bmatrix mu %lf, ll %lf, young %lf, nu %lf\n", mu, ll, young, xnu);
   }
 
-  for (int i=0; i<dimension; i++) {
-    for (int j=0; j<dimension; j++) {
-      for (int k=0; k<dimension; k++) {
-        for (int m=0; m<dimension; m++) {
-          A[i][j][k][m] = 0.0;
-        }
-      }
-    }
-  }
   // /* set Cijkl*/
 
   // for (i=0; i<dimension; i++) {
@@ -561,86 +838,121 @@ void FFTW_Slab::Bmatrix()
   //   }
   // }
 
-  /* set A, Green function and B matrix*/
-  for(k1=0;k1<local_x;k1++){
-    for(k2=0;k2<local_y;k2++){
-      for(k3=0;k3<local_z;k3++){
-        nfreq = k3+(k2)*local_z+(k1)*local_z*local_y;
-        fk[0] = fx[nfreq];
-        fk[1] = fy[nfreq];
-        fk[2] = fz[nfreq];
-        fk2 = fk[0]*fk[0]+fk[1]*fk[1]+fk[2]*fk[2];
-        fk4 = fk2*fk2;
-        if(fk2>0){
-          for (m=0; m<dimension; m++) {
-            for (n=0; n<dimension; n++) {
-              for (u=0; u<dimension; u++) {
-                for (v=0; v<dimension; v++) {
-                  A[m][n][u][v] = 0.0;
-
-                  for(i=0; i<dimension; i++) {
-                    for(j=0; j<dimension; j++) {
-                      for(k=0; k<dimension; k++) {
-
-                        G[k][i] = (2.0 * DELTA(i,k)/fk2-1.0/(1.0-xnu)*fk[i]*fk[k]/fk4)/(2.0*C44);
-                        for(l=0; l<dimension; l++) {
-                          A[m][n][u][v] = A[m][n][u][v] - C[k][l][u][v]*C[i][j][m][n]*G[k][i]*fk[j]*fk[l] ;
-                        }
-                      }
-                    }
-                  }
-                  A[m][n][u][v] = A[m][n][u][v]+C[m][n][u][v];
-                  /*printf("A %d %d %d %d %f %f %f %f\n",m,n,u,v,fk[0],fk[1],fk[2],A[m][n][u][v]);*/
-                }
-              }
-            }
-          }
+  /* set B matrix, closed form of the isotropic Green's function, each
+     thread fills whole blocks of k-points */
 
-        } /*if fk2 */
-        for(ka=0;ka<slip_systems;ka++){
-          for(kb=0;kb<slip_systems;kb++){
-            B[ka][kb][k1][k2][k3] = 0.0;
-            for (m=0; m<dimension; m++){
-              for (n=0; n<dimension; n++) {
-                for (u=0; u<dimension; u++) {
-                  for (v=0; v<dimension; v++) {
-                    B[ka][kb][k1][k2][k3]= B[ka][kb][k1][k2][k3] + A[m][n][u][v]*eps_temp[ka][m][n]*eps_temp[kb][u][v];
-                  }
-                }
-              }
-            }
+  bb_setup();
+  if (matrix_free) return;
 
-            nb = nfreq +(ka)*local_x*local_y*local_z+(kb)*local_x*local_y*local_z*slip_systems;
-            BB[nb] = B[ka][kb][k1][k2][k3]/mu;
-            /*printf("%lf %lf %lf %lf \n", fx[nfreq], fy[nfreq], fz[nfreq], BB[nb]);*/
-          } /*ka*/
-        }/* kb*/
+  int L = local_kn1*local_kn2*local_kz;
 
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(static)
+#endif
+  for (int q0 = 0; q0 < L; q0 += KBLOCK)
+    bb_block(q0,MIN(KBLOCK,L-q0),BB+q0,L);
 
-      }	/*k1*/
-    }	/*k2*/
-  }	/*k3*/
+  return;
+}
+
+/* ----------------------------------------------------------------------
+k-independent parts of B and F, with sig_a = C:eps_a
+B_ab(k) = (eps_a:C:eps_b - (sig_a k).G(k).(sig_b k))/mu for the isotropic
+Green's function G(k)
+------------------------------------------------------------------------- */
 
+void FFTW_Slab::bb_setup()
+{
+  int NS = slip_systems;
+  int ND = dimension;
+  int a, b, i, j, m, n;
+
+  memory->destroy(bb_e);
+  memory->destroy(bb_s);
+  memory->create(bb_e,NS*(NS+1)/2,"fft:bb_e");
+  memory->create(bb_s,NS*ND*ND,"fft:bb_s");
+
+  for (a = 0; a < NS; a++)
+    for (i = 0; i < ND; i++)
+      for (j = 0; j < ND; j++) {
+        double sum = 0.0;
+        for (m = 0; m < ND; m++)
+          for (n = 0; n < ND; n++)
+            sum += C[i][j][m][n]*eps[a][m][n];
+        bb_s[a*ND*ND + i*ND + j] = sum;
+      }
 
-  return;
+  for (a = 0; a < NS; a++)
+    for (b = a; b < NS; b++) {
+      double sum = 0.0;
+      for (m = 0; m < ND; m++)
+        for (n = 0; n < ND; n++)
+          sum += eps[a][m][n]*bb_s[b*ND*ND + m*ND + n];
+      bb_e[PAIR(a,b,NS)] = sum;
+    }
+}
+
+/* ----------------------------------------------------------------------
+BB of the n k-points from q0 on, bbt[PAIR(a,b)*stride + t] for k-point
+q0+t; B is 0 at k = 0
+------------------------------------------------------------------------- */
+
+void FFTW_Slab::bb_block(int q0, int n, double *bbt, int stride)
+{
+  int NS = slip_systems;
+  int ND = dimension;
+  int a, b, i, j, t;
+  double tk[NS][3], tf[NS];
+  double fk[3], fk2, c1, c2;
+  double mu = material->mu;
+  double xnu = material->xnu;
+  double C44 = material->C44;
+
+  for (t = 0; t < n; t++) {
+    fk[0] = fx[q0+t];
+    fk[1] = fy[q0+t];
+    fk[2] = fz[q0+t];
+    fk2 = 0.0;
+    for (i = 0; i < ND; i++) fk2 += fk[i]*fk[i];
+
+    if (fk2 == 0.0) {
+      for (a = 0; a < NS*(NS+1)/2; a++) bbt[a*stride + t] = 0.0;
+      continue;
+    }
+
+    // t_a = sig_a k and its projection on k
+
+    for (a = 0; a < NS; a++) {
+      double *sa = bb_s + a*ND*ND;
+      tf[a] = 0.0;
+      for (i = 0; i < ND; i++) {
+        tk[a][i] = 0.0;
+        for (j = 0; j < ND; j++) tk[a][i] += sa[i*ND + j]*fk[j];
+        tf[a] += tk[a][i]*fk[i];
+      }
+    }
+
+    c1 = 1.0/(C44*fk2);
+    c2 = 1.0/((1.0-xnu)*2.0*C44*fk2*fk2);
+    for (a = 0; a < NS; a++)
+      for (b = a; b < NS; b++) {
+        double tt = 0.0;
+        for (i = 0; i < ND; i++) tt += tk[a][i]*tk[b][i];
+        bbt[PAIR(a,b,NS)*stride + t] =
+          (bb_e[PAIR(a,b,NS)] - c1*tt + c2*tf[a]*tf[b])/mu;
+      }
+  }
 }
 
 /* ----------------------------------------------------------------------
-generate FF matrix
+generate the FF matrix, the k-points are shared by the threads; with
+matrix_free F is made per k-point in strain() instead
 ------------------------------------------------------------------------- */
 
 void FFTW_Slab::Fmatrix()
 {
-  int i, j, k, l, m, n, u, v, k1, k2, k3, ka, nv, nb, nfreq;
-  int is, js, ks;
-  double fkr;
-  //double C[dimension][dimension][dimension][dimension];
-  double F[slip_systems][dimension][dimension];
-  double D[slip_systems][dimension][dimension];
-  double G[dimension][dimension];
-  double fk[dimension];
-  double xnu, mu, ll, young, fk2, fk4, fka,fkb;
-  double A[dimension][dimension][dimension][dimension];
+  int L = local_kn1*local_kn2*local_kz;
+  double mu, ll, young, xnu;
 
   mu = material->mu;
   ll = material->ll;
@@ -651,72 +963,56 @@ void FFTW_Slab::Fmatrix()
     printf("Fmatrix mu %lf, ll %lf, young %lf, nu %lf\n", mu, ll, young, xnu);
   }
 
-  for (int i=0; i<dimension; i++) {
-    for (int j=0; j<dimension; j++) {
-      G[i][j] = 0.0;
-      for (int k=0; k<dimension; k++) {
-        for (int m=0; m<dimension; m++) {
-          A[i][j][k][m] = 0.0;
-        }
-      }
-    }
-  }
-
-  /* set Green function and F matrix*/
-
-  for(k1=0;k1<local_x;k1++)
-  for(k2=0;k2<local_y;k2++)
-  for(k3=0;k3<local_z;k3++){
-    nfreq = k3+(k2)*local_z+(k1)*local_z*local_y;
-    fk[0] = fx[nfreq];
-    fk[1] = fy[nfreq];
-    fk[2] = fz[nfreq];
-    fk2 = fk[0]*fk[0]+fk[1]*fk[1]+fk[2]*fk[2];
-    fk4 = fk2*fk2;
-
-    if(fk2>0){
-      for(m=0; m<dimension; m++)
-      for(n=0; n<dimension; n++)
-      for(u=0; u<dimension; u++)
-      for(v=0; v<dimension; v++){
-        A[m][n][u][v] = 0.0;
-
-        for(i=0; i<dimension; i++)
-        for(j=0; j<dimension; j++)
-        for (k=0; k<dimension; k++){
-          G[k][i] = (2.0 * DELTA(i,k)/fk2-1.0/(1.0-xnu)*fk[i]*fk[k]/fk4)/(2.0*mu);
-          for(l=0; l<dimension; l++){
-            A[m][n][u][v] = A[m][n][u][v] - C[k][l][u][v]*C[i][j][m][n]*G[k][i]*fk[j]*fk[l] ;
-          }
-        }
-        A[m][n][u][v] = A[m][n][u][v]+C[m][n][u][v];
-      }
-    } /*if fk2 */
+  if (matrix_free) return;
 
-    for (ka=0; ka<slip_systems; ka++)
-    for (i=0; i<dimension; i++)
-    for (j=0; j<dimension; j++){
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(static)
+#endif
+  for (int q = 0; q < L; q++)
+    ff_point(q,FF+q,L);
+}
 
-      F[ka][i][j]= 0.0;
-      D[ka][i][j]=0.0;
+/* ----------------------------------------------------------------------
+F of k-point q, with t_a = sig_a k and G the Green's function
+F_a,ij = k_i (G t_a)_j at ff[(a + i*NS + j*NS*ND)*stride], 0 at k = 0
+------------------------------------------------------------------------- */
 
-      for(k=0; k<dimension; k++)
-      for (l=0; l<dimension; l++){
-        for (m=0; m<dimension; m++)
-        for (n=0; n<dimension; n++){
-          F[ka][i][j] = F[ka][i][j] + C[k][l][m][n]*G[j][k]*eps[ka][m][n]*fk[i]*fk[l] ;
-        }
-        D[ka][i][j]=D[ka][i][j]+A[i][j][k][l]*eps[ka][k][l];
+void FFTW_Slab::ff_point(int q, double *ff, int stride)
+{
+  int NS = slip_systems;
+  int ND = dimension;
+  int ka, i, j;
+  double fk[3], tk[3], gt[3], fk2, fk4, tf;
+  double mu = material->mu;
+  double xnu = material->xnu;
+
+  fk[0] = fx[q];
+  fk[1] = fy[q];
+  fk[2] = fz[q];
+  fk2 = 0.0;
+  for (i = 0; i < ND; i++) fk2 += fk[i]*fk[i];
+  fk4 = fk2*fk2;
+
+  for (ka = 0; ka < NS; ka++) {
+    double *sa = bb_s + ka*ND*ND;
+
+    // G t_a, G built with mu
+    for (i = 0; i < ND; i++) gt[i] = 0.0;
+    if (fk2 > 0) {
+      tf = 0.0;
+      for (i = 0; i < ND; i++) {
+        tk[i] = 0.0;
+        for (j = 0; j < ND; j++) tk[i] += sa[i*ND + j]*fk[j];
+        tf += tk[i]*fk[i];
       }
-
-      nb = nfreq + (ka)*local_x*local_y*local_z + i*local_x*local_y*local_z*slip_systems + j*local_x*local_y*local_z*slip_systems*dimension;
-      FF[nb] = F[ka][i][j];
-
-      nb = nfreq + (ka)*local_x*local_y*local_z + i*local_x*local_y*local_z*slip_systems + j*local_x*local_y*local_z*slip_systems*dimension;
-      DD[nb] = D[ka][i][j];
+      for (i = 0; i < ND; i++)
+        gt[i] = (2.0*tk[i]/fk2 - fk[i]*tf/((1.0-xnu)*fk4))/(2.0*mu);
     }
-  }/*k1,k2,k3*/
-  return;
+
+    for (i = 0; i < ND; i++)
+      for (j = 0; j < ND; j++)
+        ff[(ka + i*NS + j*NS*ND)*stride] = fk[i]*gt[j];
+  }
 }
 /* ----------------------------------------------------------------------
 resolve shear stress
@@ -853,697 +1149,348 @@ void FFTW_Slab::fft_send(void *buf, int count, MPI_Datatype datatype, int dest,
     }
     /* ----------------------------------------------------------------------
     grad(xi) and line character angle theta
+    the interior x planes are done while the faces are in flight
     ------------------------------------------------------------------------- */
     void FFTW_Slab::gradient()
     {
+      int lN1 = local_x;
+
+      // the forward transform here is of xi alone, the solvers that call
+      // gradient() transform something else afterwards
+      if (grad_spectral) {
+        prepare_next_itr();
+        prep_forward();
+        spectral_theta();
+        return;
+      }
+
+      skin_start();
+      for (int i = 1; i < lN1-1; i++) gradient_plane(i);
+      skin_finish();
+      if (lN1 > 0) gradient_plane(0);
+      if (lN1 > 1) gradient_plane(lN1-1);
+    }
+
+    /* ----------------------------------------------------------------------
+    persistent exchange of the x faces of xi with the neighboring slabs,
+    periodic in x: mpi_r receives the first plane of the proc above,
+    mpi_l the last plane of the one below
+    dskin is the delta of project_core_energy(), not periodic: the mid
+    line value of the first plane goes down, one message for all planes
+    ------------------------------------------------------------------------- */
+    void FFTW_Slab::skin_setup()
+    {
+      int nmpi = slip_systems*local_y*local_z;
+      double *xi_r = skin;           //order parameters in the skin region
+      double *xi_l = skin + nmpi;
+      double *mpi_r = skin + 2*nmpi;
+      double *mpi_l = skin + 3*nmpi;
+      int up = (me+1) % nprocs;
+      int down = (me-1+nprocs) % nprocs;
+
+      skin_destroy();
+      if (nprocs == 1) return;
+
+      MPI_Recv_init(mpi_r,nmpi,MPI_DOUBLE,up,1,world,&skin_req[0]);
+      MPI_Recv_init(mpi_l,nmpi,MPI_DOUBLE,down,0,world,&skin_req[1]);
+      MPI_Send_init(xi_r,nmpi,MPI_DOUBLE,down,1,world,&skin_req[2]);
+      MPI_Send_init(xi_l,nmpi,MPI_DOUBLE,up,0,world,&skin_req[3]);
+      nskin_req = 4;
+
+      if (local_x == 0) return;
+      if (local_x_start+local_x < nx)
+        MPI_Recv_init(dskin+num_planes,num_planes,MPI_DOUBLE,me+1,2,world,
+                      &dskin_req[ndskin_req++]);
+      if (local_x_start > 0)
+        MPI_Send_init(dskin,num_planes,MPI_DOUBLE,me-1,2,world,
+                      &dskin_req[ndskin_req++]);
+    }
+
+    /* ---------------------------------------------------------------------- */
 
-      int isa, i, j, k, index0, index, na, nr, nl;
-      int nxl, nxr, nyl, nyr, nzl, nzr, dny, dnz;
-      int ig, ib;
-      int rank, np;
-      MPI_Comm_rank(MPI_COMM_WORLD, &rank);
-      MPI_Comm_size(MPI_COMM_WORLD, &np);
+    void FFTW_Slab::skin_destroy()
+    {
+      for (int i = 0; i < nskin_req; i++) MPI_Request_free(&skin_req[i]);
+      for (int i = 0; i < ndskin_req; i++) MPI_Request_free(&dskin_req[i]);
+      nskin_req = ndskin_req = 0;
+    }
 
+    /* ----------------------------------------------------------------------
+    pack the first and last x planes of xi and start their exchange,
+    on 1 proc they are their own neighbors
+    ------------------------------------------------------------------------- */
+    void FFTW_Slab::skin_start()
+    {
       int lN1 = local_x;
-      int lxs = local_x_start;
       int N2 = local_y;
       int N3 = local_z;
       int NS = slip_systems;
       int nmpi = NS*N2*N3;
-      double xi_r[nmpi], xi_l[nmpi], mpi_r[nmpi], mpi_l[nmpi]; //order parameters in the skin region
-      double d1,d2,d3;
-      d1 = d2 = d3 = 1.0;
-      double tang[3], mag;
-      MPI_Status status;
-
-      //initialize
-      for (i=0; i<nmpi; i++) {
-        xi_r[i] = 0.0;
-        xi_l[i] = 0.0;
-        mpi_r[i] = 0.0;
-        mpi_l[i] = 0.0;
-      }
-      for (i=0; i<nmpi*lN1; i++) {
-        gradx[i] = 0.0;
-        grady[i] = 0.0;
-        gradz[i] = 0.0;
-        theta[i] = 0.0;
-      }
-      tang[0] = 0.0;
-      tang[1] = 0.0;
-      tang[2] = 0.0;
-
-      // We send the skin region to the neighboring domains
-      //  It needs to work also when there is just 1 proc
-      i = 0;
-      for(isa=0;isa<NS;isa++){
-        for(j=0;j<N2;j++)
-        for(k=0;k<N3;k++){
-          nr = 2*(i*N2*N3 + j*N3 + k + isa*lN1*N2*N3);
-          index0 = j*N3 + k + isa*N2*N3;
-          xi_r[index0] = xi[0][nr];
-          if(np == 1)
-          mpi_r[index0] = xi_r[index0];
-        }
+      double *xi_r = skin;
+      double *xi_l = skin + nmpi;
+
+      if (nprocs == 1) {
+        xi_r = skin + 2*nmpi;
+        xi_l = skin + 3*nmpi;
       }
-      i = lN1-1;
-      for(isa=0;isa<NS;isa++){
-        for(j=0;j<N2;j++)
-        for(k=0;k<N3;k++){
-          nl = 2*(i*N2*N3 + j*N3 + k + isa*lN1*N2*N3);
-          index0 = j*N3 + k + isa*N2*N3;
-          xi_l[index0] = xi[0][nl];
-          if(np == 1)
-          mpi_l[index0] = xi_l[index0];
+
+      for(int isa=0;isa<NS;isa++){
+        const double *first = xi[0] + 2*isa*lN1*N2*N3;
+        const double *last = first + 2*(lN1-1)*N2*N3;
+        for(int n=0;n<N2*N3;n++){
+          xi_r[n + isa*N2*N3] = first[2*n];
+          xi_l[n + isa*N2*N3] = last[2*n];
         }
       }
 
-      if(np > 1){
+      if (nskin_req) MPI_Startall(nskin_req,skin_req);
+    }
 
-        MPI_Barrier(MPI_COMM_WORLD);
+    /* ---------------------------------------------------------------------- */
 
-        if (rank == np-1) {
-          MPI_Recv(&mpi_r, nmpi, MPI_DOUBLE, 0, 1, MPI_COMM_WORLD, &status);
-          MPI_Send(&xi_r, nmpi, MPI_DOUBLE, rank-1, 1, MPI_COMM_WORLD);
-        }
-        else if(rank == 0){
-          MPI_Send(&xi_r, nmpi, MPI_DOUBLE, np-1, 1, MPI_COMM_WORLD);
-          MPI_Recv(&mpi_r, nmpi, MPI_DOUBLE, rank+1, 1, MPI_COMM_WORLD, &status);
-        }
-        else{
-          MPI_Recv(&mpi_r, nmpi, MPI_DOUBLE, rank+1, 1, MPI_COMM_WORLD, &status);
-          MPI_Send(&xi_r, nmpi, MPI_DOUBLE, rank-1, 1, MPI_COMM_WORLD);
-        }
-        MPI_Barrier(MPI_COMM_WORLD);
+    void FFTW_Slab::skin_finish()
+    {
+      if (nskin_req) MPI_Waitall(nskin_req,skin_req,MPI_STATUSES_IGNORE);
+    }
 
-        if (rank == 0) {
-          MPI_Recv(&mpi_l, nmpi, MPI_DOUBLE, np-1, 0, MPI_COMM_WORLD, &status);
-          MPI_Send(&xi_l, nmpi, MPI_DOUBLE, rank+1, 0, MPI_COMM_WORLD);
-        }
-        else if(rank == np-1){
-          MPI_Send(&xi_l, nmpi, MPI_DOUBLE, 0, 0, MPI_COMM_WORLD);
-          MPI_Recv(&mpi_l, nmpi, MPI_DOUBLE, rank-1, 0, MPI_COMM_WORLD, &status);
-        }
-        else{
-          MPI_Recv(&mpi_l, nmpi, MPI_DOUBLE, rank-1, 0, MPI_COMM_WORLD, &status);
-          MPI_Send(&xi_l, nmpi, MPI_DOUBLE, rank+1, 0, MPI_COMM_WORLD);
+    /* ----------------------------------------------------------------------
+    theta on x plane i of every slip system, central differences with the
+    skin across the slab faces, the gradient itself is not kept
+    ------------------------------------------------------------------------- */
+    void FFTW_Slab::gradient_plane(int i)
+    {
+      int lN1 = local_x;
+      int N2 = local_y;
+      int N3 = local_z;
+      int NS = slip_systems;
+      int nmpi = NS*N2*N3;
+      const double *mpi_r = skin + 2*nmpi;
+      const double *mpi_l = skin + 3*nmpi;
+      const double *x = xi[0];
+
+      for(int isa=0;isa<NS;isa++){
+        for(int j=0;j<N2;j++){
+          int index = i*N2*N3 + j*N3 + isa*lN1*N2*N3;
+          int index0 = j*N3 + isa*N2*N3;
+          int nyl = (j == 0) ? (N2-1)*N3 : -N3;
+          int nyr = (j == N2-1) ? -(N2-1)*N3 : N3;
+          for(int k=0;k<N3;k++,index++,index0++){
+            double xl = (i == 0) ? mpi_l[index0] : x[2*(index-N2*N3)];
+            double xr = (i == lN1-1) ? mpi_r[index0] : x[2*(index+N2*N3)];
+            double yl = x[2*(index+nyl)];
+            double yr = x[2*(index+nyr)];
+            double zl = x[2*(index + (k == 0 ? N3-1 : -1))];
+            double zr = x[2*(index + (k == N3-1 ? 1-N3 : 1))];
+            theta[index] = line_angle(isa,(xr-xl)/2,(yr-yl)/2,(zr-zl)/2);
+          }
         }
-        MPI_Barrier(MPI_COMM_WORLD);
       }
+    }
 
-      // Once we have the skin we can calculate the gradient
+    /* ----------------------------------------------------------------------
+    angle between the dislocation line and the Burgers vector of slip
+    system isa, from grad(xi) on the local grid; the line is the normal
+    cross the gradient once that is rotated to the global axes, -1 where
+    the gradient is too small to define it
+    ------------------------------------------------------------------------- */
+    double FFTW_Slab::line_angle(int isa, double gx, double gy, double gz)
+    {
+      // transformation of the gradient from the local to global grid
+      double g0 = gx, g1 = gy, g2 = gz;
+      gx = g0*four[0][0] + g1*four[1][0] + g2*four[2][0];
+      gy = g0*four[0][1] + g1*four[1][1] + g2*four[2][1];
+      gz = g0*four[0][2] + g1*four[1][2] + g2*four[2][2];
 
-      for(isa=0;isa<NS;isa++){
+      return line_angle_global(isa,gx,gy,gz);
+    }
 
-        for(i=0;i<lN1;i++)
-        for(j=0;j<N2;j++)
-        for(k=0;k<N3;k++){
-          index = i*N2*N3 + j*N3 + k + isa*lN1*N2*N3;
-          index0 = j*N3 + k + isa*N2*N3;
-          na = 2 * index; // = 2*(i*N2*N3 + j*N3 + k + isa*lN1*N2*N3);
-          //gradx
-          nxr = na + 2*N2*N3; // = 2*((i+1)*N2*N3 + j*N3 + k + isa*lN1*N2*N3);
-          nxl = na - 2*N2*N3; // = 2*((i-1)*N2*N3 + j*N3 + k + isa*lN1*N2*N3);
-          if (i==0) {
-            gradx[index] = (xi[0][nxr]-mpi_l[index0])/2;
-          }
-          else if (i==lN1-1){
-            gradx[index] = (mpi_r[index0]-xi[0][nxl])/2;
-          }
-          else {
-            gradx[index] = (xi[0][nxr]-xi[0][nxl])/2;
-          }
+    /* ----------------------------------------------------------------------
+    line_angle() of a gradient already on the global axes
+    ------------------------------------------------------------------------- */
+    double FFTW_Slab::line_angle_global(int isa, double gx, double gy, double gz)
+    {
+      double tang[3], mag, dir, angle;
+
+      tang[0] = gy*xn[isa][2] - gz*xn[isa][1];
+      tang[1] = gz*xn[isa][0] - gx*xn[isa][2];
+      tang[2] = gx*xn[isa][1] - gy*xn[isa][0];
+      mag = sqrt(tang[0]*tang[0]+tang[1]*tang[1]+tang[2]*tang[2]);
+      if (mag<=0.1) return -1;
+
+      tang[0] /= mag;
+      tang[1] /= mag;
+      tang[2] /= mag;
+      angle = acos(tang[0]*xb[isa][0]+tang[1]*xb[isa][1]+tang[2]*xb[isa][2]);
+      dir = (xb[isa][1]*tang[2]-xb[isa][2]*tang[1])*xn[isa][0]+
+      (xb[isa][2]*tang[0]-xb[isa][0]*tang[2])*xn[isa][1]+
+      (xb[isa][0]*tang[1]-xb[isa][1]*tang[0])*xn[isa][2];
+      if (dir<0.0) angle = acos(-1)-angle;
+      return angle;
+    }
 
-          //grady
-          nyr = na + 2*N3; // = 2*(i*N2*N3 + (j+1)*N3 + k + isa*lN1*N2*N3);
-          nyl = na - 2*N3; // = 2*(i*N2*N3 + (j-1)*N3 + k + isa*lN1*N2*N3);
-          dny = 2*(N2-1)*N3;
-          if (j==0) {
-            grady[index] = (xi[0][nyr]-xi[0][na+dny])/2;
-          }
-          else if (j==N2-1){
-            grady[index] = (xi[0][na-dny]-xi[0][nyl])/2;
-          }
-          else {
-            grady[index] = (xi[0][nyr]-xi[0][nyl])/2;
+    /* ----------------------------------------------------------------------
+    theta from grad(xi) on the spectrum of xi in data_fftw, as the forward
+    transform leaves it; along each grid axis the stencil's central
+    difference is i sin(2 pi k/n) xi_hat, so both give the same gradient,
+    here rotated to the global axes with four; the three components of a
+    slip system go through one batched backward transform and no halo is
+    exchanged
+    ------------------------------------------------------------------------- */
+    void FFTW_Slab::spectral_theta()
+    {
+      int lN1 = local_x;
+      int N2 = local_y;
+      int N3 = local_z;
+      int NS = slip_systems;
+      int DS = total_local_size;
+      int NK2 = 2*local_kz;
+      int nsite = lN1*N2*N3;
+      int gs = grad_interleaved ? 3 : 1;     // stride of one component
+      int gd = grad_interleaved ? 1 : DS;    // distance between components
+      int rd = grad_interleaved ? 1 : 2*DS;  // the same in doubles, r2c
+      int i, j, k, kx, ky, nf, m, r;
+      double *rgrad = (double *) data_grad;
+      const double *sx = gsin;
+      const double *sy = gsin + nx;
+      const double *sz = gsin + nx + ny;
+      double g[3];
+
+      // the 1/N the backward transform leaves out
+      double scale = 1.0/(static_cast<double>(nx)*ny*nz);
+
+      for(int isa=0;isa<NS;isa++){
+        for(i=0;i<local_kn1;i++)
+          for(j=0;j<local_kn2;j++){
+            if (kspace_transposed) {
+              kx = j;
+              ky = local_y_start_after_trans+i;
+            }
+            else {
+              kx = local_x_start+i;
+              ky = local_y_start+j;
+            }
+            for(k=0;k<local_kz;k++){
+              nf = k + j*local_kz + i*local_kz*local_kn2;
+              const FFT_DATA &x = data_fftw[nf + isa*DS];
+              double s0 = scale*sx[kx];
+              double s1 = scale*sy[ky];
+              double s2 = scale*sz[local_z_start+k];
+              for(int c=0;c<3;c++){
+                double d = s0*four[0][c] + s1*four[1][c] + s2*four[2][c];
+                data_grad[nf*gs + c*gd].re = -d*x.im;
+                data_grad[nf*gs + c*gd].im = d*x.re;
+              }
+            }
           }
 
-          //gradz
-          nzr = na + 2; // = 2*(i*N2*N3 + j*N3 + (k+1) + isa*lN1*N2*N3);
-          nzl = na - 2; // = 2*(i*N2*N3 + j*N3 + (k-1) + isa*lN1*N2*N3);
-          dnz = 2*(N3-1);
-          if (k==0) {
-            gradz[index] = (xi[0][nzr]-xi[0][na+dnz])/2;
-          }
-          else if (k==N3-1){
-            gradz[index] = (xi[0][na-dnz]-xi[0][nzl])/2;
-          }
-          else {
-            gradz[index] = (xi[0][nzr]-xi[0][nzl])/2;
-          }
-        }//ijk
-      }//isa
+        backward_gradient();
 
-      // transformation of the gradient from the local to global grid
-      for(isa=0;isa<NS;isa++){
         for(i=0;i<lN1;i++)
-        for(j=0;j<N2;j++)
-        for(k=0;k<N3;k++){
-          index = i*N2*N3 + j*N3 + k + isa*lN1*N2*N3;
-          gradx[index] = gradx[index]*four[0][0] + grady[index]*four[1][0] + gradz[index]*four[2][0];
-          grady[index] = gradx[index]*four[0][1] + grady[index]*four[1][1] + gradz[index]*four[2][1];
-          gradz[index] = gradx[index]*four[0][2] + grady[index]*four[1][2] + gradz[index]*four[2][2];
-        }
+          for(j=0;j<N2;j++)
+            for(k=0;k<N3;k++){
+              m = i*N2*N3 + j*N3 + k;
+              r = i*N2*NK2 + j*NK2 + k;
+              for(int c=0;c<3;c++)
+                g[c] = r2c ? rgrad[r*gs + c*rd] : data_grad[m*gs + c*gd].re;
+              theta[m + isa*nsite] = line_angle_global(isa,g[0],g[1],g[2]);
+            }
+      }
+    }
+
+    /* ----------------------------------------------------------------------
+    start of an iteration in one pass over the x planes of the slab:
+    theta when the core energy or a dump reads it, the core energy of the
+    plane and xi copied into data_fftw for the forward FFT, as
+    init_loop(), gradient(), app->core_energy() and prepare_next_itr()
+    would in four; the interior planes are done while the faces are in
+    flight
+    ------------------------------------------------------------------------- */
+    void FFTW_Slab::sweep()
+    {
+      int lN1 = local_x;
+      int stencil = theta_flag && !grad_spectral;
+      double esum = 0.0;
+
+      // the step's forward transform is done first and kept for the
+      // solver, theta comes from its spectrum
+      if (theta_flag && grad_spectral) {
+        prepare_next_itr();
+        prep_forward();
+        spectral_theta();
+        spectrum_ready = 1;
       }
+      if (stencil) skin_start();
+      if (app->core) app->core->setup();
 
-      double dir;
-      for(isa=0;isa<NS;isa++){
+      for (int i = 1; i < lN1-1; i++) esum += sweep_plane(i);
+      if (stencil) skin_finish();
+      if (lN1 > 0) esum += sweep_plane(0);
+      if (lN1 > 1) esum += sweep_plane(lN1-1);
 
-        for(i=0;i<lN1;i++)
-        for(j=0;j<N2;j++)
-        for(k=0;k<N3;k++){
-          index = i*N2*N3 + j*N3 + k + isa*lN1*N2*N3;
-          tang[0] = grady[index]*xn[isa][2] - gradz[index]*xn[isa][1];
-          tang[1] = gradz[index]*xn[isa][0] - gradx[index]*xn[isa][2];
-          tang[2] = gradx[index]*xn[isa][1] - grady[index]*xn[isa][0];
-          mag = sqrt(tang[0]*tang[0]+tang[1]*tang[1]+tang[2]*tang[2]);
-          if (mag<=0.1) {
-            theta[index]= -1; //define
-          }
-          else {
-            tang[0] /= mag;
-            tang[1] /= mag;
-            tang[2] /= mag;
-            theta[index] = acos(tang[0]*xb[isa][0]+tang[1]*xb[isa][1]+tang[2]*xb[isa][2]);
-            dir = (xb[isa][1]*tang[2]-xb[isa][2]*tang[1])*xn[isa][0]+
-            (xb[isa][2]*tang[0]-xb[isa][0]*tang[2])*xn[isa][1]+
-            (xb[isa][0]*tang[1]-xb[isa][1]*tang[0])*xn[isa][2];
-            if (dir<0.0) {
-              theta[index]=acos(-1)-theta[index];
-            }
-            // dir[index] = (xb[isa][1]*tang[2]-xb[isa][2]*tang[1])*xn[isa][0]+
-            //       (xb[isa][2]*tang[0]-xb[isa][0]*tang[2])*xn[isa][1]+
-            //       (xb[isa][0]*tang[1]-xb[isa][1]*tang[0])*xn[isa][2];
-            // if (dir[index]<0.0) {
-            //     theta[index]=acos(-1)-theta[index];
-            // }
+      E_core = esum/nx;
+    }
+
+    /* ----------------------------------------------------------------------
+    sweep() on x plane i, returns its core energy
+    ------------------------------------------------------------------------- */
+    double FFTW_Slab::sweep_plane(int i)
+    {
+      int lN1 = local_x;
+      int N2 = local_y;
+      int N3 = local_z;
+      int NS = slip_systems;
+      int nplane = N2*N3;
+      int nsite = lN1*nplane;
+      int DS = total_local_size;
+      int NK2 = 2*local_kz;
+      int lo = i*nplane, hi = lo + nplane;
+      double *rdata = (double *) data_fftw;
+      CoreEnergy *core = app->core;
+      double esum = 0.0;
+
+      for (int n = 2*lo; n < 2*hi; n++) xi_sum[0][n] = 0.0;
+
+      if (theta_flag && !grad_spectral) gradient_plane(i);
+
+      if (core) esum = core->tile(lo,hi);
+      else
+        for (int isa = 0; isa < NS; isa++)
+          for (int m = lo; m < hi; m++) dE_core[m + isa*nsite] = 0.0;
+
+      // the glide plane transform reads xi itself, and a spectrum from
+      // spectral_theta() already holds it
+      if (zactive || spectrum_ready) return esum;
+
+      for (int isa = 0; isa < NS; isa++) {
+        const double *x = xi[0] + 2*(lo + isa*nsite);
+        if (r2c) {
+          double *out = rdata + i*N2*NK2 + 2*isa*DS;
+          for (int j = 0; j < N2; j++)
+            for (int k = 0; k < N3; k++) out[j*NK2 + k] = x[2*(j*N3 + k)];
+        }
+        else {
+          FFT_DATA *out = data_fftw + lo + isa*DS;
+          for (int m = 0; m < nplane; m++) {
+            out[m].re = x[2*m];
+            out[m].im = x[2*m+1];
           }
-        }//ijk
-      }//isa
+        }
+      }
+
+      return esum;
     }
 
     /* -----------------------------------------------------------------------
-    bcc core energy for perfect dislocations
+    Project core energy for output
     ---------------------------------------------------------------------*/
-    void FFTW_Slab::core_energy_bcc_perfect()
+    void FFTW_Slab::project_core_energy()
     {
-      int i, j, k, isa, index, num;
-      int tag;
-
+      int index, index1, index2, index3, indexdx;
+      int counter, marker, countSF, cSF, count;
+      double dx, mpidel, p, totAR, sfAR;
       int ND = dimension;
       int N1 = nx;
-      double size = static_cast<double>(N1);
-      int lN1 = local_x;
-      int lxs = local_x_start;
-      int N2 = local_y;
-      int N3 = local_z;
-      int NP = num_planes;
-      int NS = slip_systems;
-      double dslip = material->dslip;
-
-      int NT = solve->max_iter;
-      int NSI = app->stoptime;
-
-      double usf = material->usf;
-      double b = material->b;
-      double mu = material->mu;
-      //   if(me == 0){
-      //     if (logfile) fprintf(logfile,"b = %e\n", b);
-      //     if (screen) fprintf(screen,"b = %e, usf = %lf, mu = %lf\n", b,usf,mu);
-      // }
-      // double ll = material->ll;
-      // double young = material->young;
-      // double xnu = material->xnu;
-      usf = usf/(mu*dslip*b);
-
-      // Checking without core energy
-      //An = 0;
-      double cof;
-      E_core = 0;
-
-      for(isa=0;isa<NS;isa++){
-        for(i=0;i<lN1;i++)
-        for(j=0;j<N2;j++)
-        for(k=0;k<N3;k++){
-          index = i*N2*N3 + j*N3 + k + isa*lN1*N2*N3;
-          if (theta[index]<0.0) {
-            cof = 1.0;
-          }
-          else if( theta[index]<1.23 ) {
-            cof= 1.1603*theta[index]*theta[index] - 2.0431*theta[index]+1;
-          }
-
-          else{
-            cof=0.5473*theta[index]*theta[index] - 2.0035*theta[index]+1.8923;
-          }
-          E_core += usf*cof*(sin(M_PI*data_fftw[index].re)*sin(M_PI*data_fftw[index].re))/N1;   //To make it general fft->data_fftw hasz to be general
-          dE_core[index] = usf*cof*M_PI*sin(2.0*M_PI*data_fftw[index].re);
-        }/*ijk*/
-      }/*isa*/
-    }
-
-    /* -----------------------------------------------------------------------
-    core energy for perfect dislocations
-    ---------------------------------------------------------------------*/
-    void FFTW_Slab::core_energy_perfect()
-    {
-      int i, j, k, isa, index, num;
-      int tag;
-
-      int ND = dimension;
-      int N1 = nx;
-      double size = static_cast<double>(N1);
-      int lN1 = local_x;
-      int lxs = local_x_start;
-      int N2 = local_y;
-      int N3 = local_z;
-      int NP = num_planes;
-      int NS = slip_systems;
-      double dslip = material->dslip;
-
-      int NT = solve->max_iter;
-      int NSI = app->stoptime;
-
-      double c0 = material->c0;
-      double c1 = material->c1;
-      double c2 = material->c2;
-      double c3 = material->c3;
-      double c4 = material->c4;
-      double a1 = material->a1;
-      double a3 = material->a3;
-      double isf = material->isf;
-      double usf = material->usf;
-      double An = material->An;
-      double Cn = material->Cn;
-      double b = material->b;
-
-      double mu = material->mu;
-      double ll = material->ll;
-      double young = material->young;
-      double xnu = material->xnu;
-
-      c0 = c0/(mu);
-      c1 = c1/(mu);
-      c2 = c2/(mu);
-      c3 = c3/(mu);
-      c4 = c4/(mu);
-      a1 = a1/(mu);
-      a3 = a3/(mu);
-      isf = isf/(mu*dslip*b);
-      An = An/(mu*dslip*b);
-      Cn = (usf - (isf/2.0))/(mu*dslip*b);
-
-      E_core = 0;
-      // Checking without core energy
-      //An = 0;
-
-      for(isa=0;isa<NS;isa++){
-        for(i=0;i<lN1;i++)
-        for(j=0;j<N2;j++)
-        for(k=0;k<N3;k++){
-          index = i*N2*N3 + j*N3 + k + isa*lN1*N2*N3;
-          E_core += An*(sin(M_PI*data_fftw[index].re)*sin(M_PI*data_fftw[index].re))/N1;   //To make it general fft->data_fftw hasz to be general
-          dE_core[index] = An*M_PI*sin(2.0*M_PI*data_fftw[index].re);
-        }/*ijk*/
-      }/*isa*/
-    }
-
-    /* -----------------------------------------------------------------------
-    core energy for variable USFE
-    ---------------------------------------------------------------------*/
-    void FFTW_Slab::core_energy_mpea()
-    {
-      int i, j, k, isa, index, num, core_index;
-      int tag;
-
-      int ND = dimension;
-      int N1 = nx;
-      double size = static_cast<double>(N1);
-      int lN1 = local_x;
-      int lxs = local_x_start;
-      int N2 = local_y;
-      int N3 = local_z;
-      int NP = num_planes;
-      int NS = slip_systems;
-      double dslip = material->dslip;
-
-      int NT = solve->max_iter;
-      int NSI = app->stoptime;
-
-      double * A_mpea = material->A_mpea;
-      double b = material->b;
-
-      double mu = material->mu;
-      double ll = material->ll;
-      double young = material->young;
-      double xnu = material->xnu;
-
-      E_core = 0;
-
-      for(isa=0;isa<NS;isa++){
-        for(i=0;i<lN1;i++)
-          for(j=0;j<N2;j++)
-            for(k=0;k<N3;k++){
-              index = i*N2*N3 + j*N3 + k + isa*lN1*N2*N3;
-              core_index = (lxs+i)*N2*N3 + j*N3 + k + isa*N1*N2*N3;
-              E_core += A_mpea[core_index]/(mu*dslip*b)*(sin(M_PI*data_fftw[index].re)*sin(M_PI*data_fftw[index].re))/N1;
-              dE_core[index] = A_mpea[core_index]/(mu*dslip*b)*M_PI*sin(2.0*M_PI*data_fftw[index].re);
-        }/*ijk*/
-      }/*isa*/
-    }
-
-    /* -----------------------------------------------------------------------
-    core energy extended dislocations
-    ---------------------------------------------------------------------*/
-    /* Claire added extended energy 07/30/18 to account for partial dislocations
-    and the Schoeck parameterization. Can be used for both fcc {111} planes and
-    hcp {0001} basal planes to model partial dislocations*/
-    void FFTW_Slab::core_energy_extended()
-    {
-      int i, j, k, isa, index, index1, index2, index3, plane, num;
-      int tag;
-      //  int counter, marker, tag, countSF, cSF, count;
-
-      int ND = dimension;
-      int N1 = nx;
-      double size = static_cast<double>(N1);
-      int lN1 = local_x;
-      int lxs = local_x_start;
-      int N2 = local_y;
-      int N3 = local_z;
-      int NP = num_planes;
-      int NS = slip_systems;
-      double dslip = material->dslip;
-
-      int NT = solve->max_iter;
-      int NSI = app->stoptime;
-
-      double c0 = material->c0;
-      double c1 = material->c1;
-      double c2 = material->c2;
-      double c3 = material->c3;
-      double c4 = material->c4;
-      double a1 = material->a1;
-      double a3 = material->a3;
-      double isf = material->isf;
-      double usf = material->usf;
-      double An = material->An;
-      double Cn = material->Cn;
-      double b = material->b;
-
-      double mu = material->mu;
-      double ll = material->ll;
-      double young = material->young;
-      double xnu = material->xnu;
-
-      c0 = c0/(mu);
-      c1 = c1/(mu);
-      c2 = c2/(mu);
-      c3 = c3/(mu);
-      c4 = c4/(mu);
-      a1 = a1/(mu);
-      a3 = a3/(mu);
-      isf = isf/(mu*dslip*b);
-      An = An/(mu*dslip*b);
-      Cn = (usf - (isf/2.0))/(mu*dslip*b);
-
-      //  counter = 0;
-      //  countSF = 0;
-      //  marker = 0;
-
-      /*as of now the planes need to be in the correct order initially for this to work
-      also make sure to call this subroutine before the FFTW functions are called so that data_fftw = xi[na0] or double check that this is true.
-      subroutine calculates core energy for each time step, need to called every time step and initialize every time step.*/
-
-      for(isa=0;isa<NS;isa++){
-        for(i=0;i<lN1;i++)
-        for(j=0;j<N2;j++)
-        for(k=0;k<N3;k++){
-          index = i*N2*N3 + j*N3 + k + isa*lN1*N2*N3;
-          data_core[index].re = data_fftw[index].re;
-          data_core[index].im = data_fftw[index].im;
-        }/*ijk*/
-      }/*isa*/
-
-      for(plane=0;plane<NP;plane++){
-        for(i=0;i<lN1;i++)
-        for(j=0;j<N2;j++)
-        for(k=0;k<N3;k++){
-          index = i*N2*N3 + j*N3 + k + plane*lN1*N2*N3;
-          index1 = i*N2*N3 + j*N3 + k + 0*lN1*N2*N3 + plane*lN1*N2*N3*3;
-          index2 = i*N2*N3 + j*N3 + k + 1*lN1*N2*N3 + plane*lN1*N2*N3*3;
-          index3 = i*N2*N3 + j*N3 + k + 2*lN1*N2*N3 + plane*lN1*N2*N3*3;
-
-          /*no derivatives taken use to calculate E_core*/
-
-          fcore[index] = (c0 + c1*(cos(2.0*M_PI*(data_core[index1].re-data_core[index2].re)) + cos(2.0*M_PI*(data_core[index2].re-data_core[index3].re)) + cos(2.0*M_PI*(data_core[index3].re-data_core[index1].re))) + c2*(cos(2.0*M_PI*(2.0*data_core[index1].re-data_core[index2].re-data_core[index3].re)) + cos(2.0*M_PI*(2.0*data_core[index2].re-data_core[index3].re-data_core[index1].re)) + cos(2.0*M_PI*(2.0*data_core[index3].re-data_core[index1].re-data_core[index2].re))) + c3*(cos(4.0*M_PI*(data_core[index1].re-data_core[index2].re)) + cos(4.0*M_PI*(data_core[index2].re-data_core[index3].re)) + cos(4.0*M_PI*(data_core[index3].re-data_core[index1].re))) + c4*(cos(2.0*M_PI*(3.0*data_core[index1].re-data_core[index2].re-2.0*data_core[index3].re)) + cos(2.0*M_PI*(3.0*data_core[index1].re-2.0*data_core[index2].re-data_core[index3].re)) + cos(2*M_PI*(3.0*data_core[index2].re-data_core[index3].re-2.0*data_core[index1].re)) + cos(2.0*M_PI*(3.0*data_core[index2].re-2.0*data_core[index3].re-data_core[index1].re)) + cos(2.0*M_PI*(3.0*data_core[index3].re-data_core[index1].re-2.0*data_core[index2].re)) + cos(2.0*M_PI*(3.0*data_core[index3].re-2.0*data_core[index1].re-data_core[index2].re))) + a1*(sin(2.0*M_PI*(data_core[index1].re-data_core[index2].re)) + sin(2.0*M_PI*(data_core[index2].re-data_core[index3].re)) + sin(2.0*M_PI*(data_core[index3].re-data_core[index1].re))) + a3*(sin(4.0*M_PI*(data_core[index1].re-data_core[index2].re)) + sin(4.0*M_PI*(data_core[index2].re-data_core[index3].re)) + sin(4.0*M_PI*(data_core[index3].re-data_core[index1].re))))/(dslip*b);
-
-          MPI_Reduce(&fcore[index], &f_core[index], 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
-
-          //            E_core += (f_core[index]/nsize);
-
-          /*partial derivative wrt phase field 1*/
-          df1core[index] = ((2.0*M_PI)/(dslip*b))*(c1*(sin(2.0*M_PI*(data_core[index2].re-data_core[index1].re)) + sin(2.0*M_PI*(data_core[index3].re-data_core[index1].re))) + c2*(2.0*sin(2.0*M_PI*(data_core[index2].re+data_core[index3].re-2.0*data_core[index1].re)) + sin(2.0*M_PI*(2.0*data_core[index2].re-data_core[index3].re-data_core[index1].re)) + sin(2.0*M_PI*(2.0*data_core[index3].re-data_core[index1].re-data_core[index2].re))) + (2.0*c3)*(sin(4.0*M_PI*(data_core[index2].re-data_core[index1].re)) + sin(4.0*M_PI*(data_core[index3].re-data_core[index1].re))) + c4*(3.0*sin(2.0*M_PI*(data_core[index2].re+2.0*data_core[index3].re-3.0*data_core[index1].re)) + 3.0*sin(2.0*M_PI*(2.0*data_core[index2].re+data_core[index3].re-3.0*data_core[index1].re)) + 2.0*sin(2.0*M_PI*(3.0*data_core[index2].re-data_core[index3].re-2.0*data_core[index1].re)) + sin(2.0*M_PI*(3.0*data_core[index2].re-2.0*data_core[index3].re-data_core[index1].re)) + sin(2.0*M_PI*(3.0*data_core[index3].re-data_core[index1].re-2.0*data_core[index2].re)) + 2.0*sin(2.0*M_PI*(3.0*data_core[index3].re-2.0*data_core[index1].re-data_core[index2].re))) + a1*(cos(2.0*M_PI*(data_core[index1].re-data_core[index2].re)) - cos(2.0*M_PI*(data_core[index3].re-data_core[index1].re))) + (2.0*a3)*(cos(4.0*M_PI*(data_core[index1].re-data_core[index2].re)) - cos(4.0*M_PI*(data_core[index3].re-data_core[index1].re))));
-
-          /*partial derivative wrt phase field 2*/
-          df2core[index] = ((2.0*M_PI)/(dslip*b))*(c1*(sin(2.0*M_PI*(data_core[index1].re-data_core[index2].re)) + sin(2.0*M_PI*(data_core[index3].re-data_core[index2].re))) + c2*(sin(2.0*M_PI*(2.0*data_core[index1].re-data_core[index2].re-data_core[index3].re)) + 2.0*sin(2.0*M_PI*(data_core[index3].re+data_core[index1].re-2.0*data_core[index2].re)) + sin(2.0*M_PI*(2.0*data_core[index3].re-data_core[index1].re-data_core[index2].re))) + (2.0*c3)*(sin(4.0*M_PI*(data_core[index1].re-data_core[index2].re)) + sin(4.0*M_PI*(data_core[index3].re-data_core[index2].re))) + c4*(sin(2.0*M_PI*(3.0*data_core[index1].re-data_core[index2].re-2.0*data_core[index3].re)) + 2.0*sin(2.0*M_PI*(3.0*data_core[index1].re-2.0*data_core[index2].re-data_core[index3].re)) + 3.0*sin(2.0*M_PI*(data_core[index3].re+2.0*data_core[index1].re-3.0*data_core[index2].re)) + 3.0*sin(2.0*M_PI*(2.0*data_core[index3].re+data_core[index1].re-3.0*data_core[index2].re)) + 2.0*sin(2.0*M_PI*(3.0*data_core[index3].re-data_core[index1].re-2.0*data_core[index2].re)) + sin(2.0*M_PI*(3.0*data_core[index3].re-2.0*data_core[index1].re-data_core[index2].re))) + a1*(cos(2.0*M_PI*(data_core[index2].re-data_core[index3].re)) - cos(2.0*M_PI*(data_core[index1].re-data_core[index2].re))) + (2.0*a3)*(cos(4.0*M_PI*(data_core[index2].re-data_core[index3].re)) - cos(4.0*M_PI*(data_core[index1].re-data_core[index2].re))));
-
-          /*partial derivative wrt phase field 3*/
-          df3core[index] = ((2.0*M_PI)/(dslip*b))*(c1*(sin(2.0*M_PI*(data_core[index2].re-data_core[index3].re)) + sin(2.0*M_PI*(data_core[index1].re-data_core[index3].re))) + c2*(sin(2.0*M_PI*(2.0*data_core[index1].re-data_core[index2].re-data_core[index3].re)) + sin(2.0*M_PI*(2.0*data_core[index2].re-data_core[index3].re-data_core[index1].re)) + 2.0*sin(2.0*M_PI*(data_core[index1].re+data_core[index2].re-2.0*data_core[index3].re))) + (2.0*c3)*(sin(4.0*M_PI*(data_core[index2].re-data_core[index3].re)) + sin(4.0*M_PI*(data_core[index1].re-data_core[index3].re))) + c4*(2.0*sin(2.0*M_PI*(3.0*data_core[index1].re-data_core[index2].re-2.0*data_core[index3].re)) + sin(2.0*M_PI*(3.0*data_core[index1].re-2.0*data_core[index2].re-data_core[index3].re)) + sin(2.0*M_PI*(3.0*data_core[index2].re-data_core[index3].re-2.0*data_core[index1].re)) + 2.0*sin(2.0*M_PI*(3.0*data_core[index2].re-2.0*data_core[index3].re-data_core[index1].re)) + 3.0*sin(2.0*M_PI*(data_core[index1].re+2.0*data_core[index2].re-3.0*data_core[index3].re)) + 3.0*sin(2.0*M_PI*(2.0*data_core[index1].re+data_core[index2].re-3.0*data_core[index3].re))) + a1*(cos(2.0*M_PI*(data_core[index3].re-data_core[index1].re)) - cos(2.0*M_PI*(data_core[index2].re-data_core[index3].re))) + (2.0*a3)*(cos(4.0*M_PI*(data_core[index3].re-data_core[index1].re)) - cos(4.0*M_PI*(data_core[index2].re-data_core[index3].re))));
-        }/*ijk*/
-      }/*plane*/
-
-      for(plane=0;plane<NP;plane++){
-        for(i=0;i<lN1;i++)
-        for(j=0;j<N2;j++)
-        for(k=0;k<N3;k++){
-          index = i*N2*N3 + j*N3 + k + plane*lN1*N2*N3;
-          index1 = i*N2*N3 + j*N3 + k + 0*lN1*N2*N3 + plane*lN1*N2*N3*3;
-          index2 = i*N2*N3 + j*N3 + k + 1*lN1*N2*N3 + plane*lN1*N2*N3*3;
-          index3 = i*N2*N3 + j*N3 + k + 2*lN1*N2*N3 + plane*lN1*N2*N3*3;
-
-          dE_core[index1] = df1core[index];
-          dE_core[index2] = df2core[index];
-          dE_core[index3] = df3core[index];
-        }/*ijk*/
-      }/*plane*/
-      MPI_Barrier(MPI_COMM_WORLD);
-
-    }
-    /* -----------------------------------------------------------------------
-    core energy sine approximation
-    ---------------------------------------------------------------------*/
-    /* Added by Claire 8/1/18: a 1D Sine approximations for use modeling hcp
-    non-basal slip planes with GSFE that suggests partial dislocations */
-    void FFTW_Slab::core_energy_sine()
-    {
-      int i, j, k, isa, index, num;
-      int tag;
-
-      int ND = dimension;
-      int N1 = nx;
-      double size = static_cast<double>(N1);
-      int lN1 = local_x;
-      int lxs = local_x_start;
-      int N2 = local_y;
-      int N3 = local_z;
-      int NP = num_planes;
-      int NS = slip_systems;
-      double dslip = material->dslip;
-
-      int NT = solve->max_iter;
-      int NSI = app->stoptime;
-
-      double c0 = material->c0;
-      double c1 = material->c1;
-      double c2 = material->c2;
-      double c3 = material->c3;
-      double c4 = material->c4;
-      double a1 = material->a1;
-      double a3 = material->a3;
-      double isf = material->isf;
-      double usf = material->usf;
-      double An = material->An;
-      double Cn = material->Cn;
-      double b = material->b;
-
-      double mu = material->mu;
-      double ll = material->ll;
-      double young = material->young;
-      double xnu = material->xnu;
-
-      c0 = c0/(mu);
-      c1 = c1/(mu);
-      c2 = c2/(mu);
-      c3 = c3/(mu);
-      c4 = c4/(mu);
-      a1 = a1/(mu);
-      a3 = a3/(mu);
-      isf = isf/(mu*dslip*b);
-      An = An/(mu*dslip*b);
-      Cn = (usf - (isf/2.0))/(mu*dslip*b);
-      E_core = 0;
-
-      for(isa=0;isa<NS;isa++){
-        for(i=0;i<lN1;i++)
-        for(j=0;j<N2;j++)
-        for(k=0;k<N3;k++){
-          index = i*N2*N3 + j*N3 + k + isa*lN1*N2*N3;
-          E_core += (isf*(sin(M_PI*data_fftw[index].re)*sin(M_PI*data_fftw[index].re)) + Cn*(sin(2*M_PI*data_fftw[index].re)*sin(2*M_PI*data_fftw[index].re)))/N1;
-          dE_core[index] = (isf*M_PI*sin(2*M_PI*data_fftw[index].re) + Cn*2*M_PI*sin(4*M_PI*data_fftw[index].re));
-        }/*ijk*/
-      }/*isa*/
-    }
-
-    /* -----------------------------------------------------------------------
-    core energy gamma surface
-    ----------------------------------------------------------------------*/
-    /* Changed by Claire 8/1/18: was core_energy_isf_usf but I
-    changed to core_energy_pyrII to account for pyramidal II slip in HCP uses
-    a fourier series to parameterize the 1D GSFE that governs the dissociation of
-    perfect dislocations into partials with Burgers vectors in the same Direction
-    with half the magnitude. The GSFE curve isn't symmetric which is why the
-    parameterization is different than that for core_flag == 3, the sine approx */
-    void FFTW_Slab::core_energy_pyrII()
-    {
-      int i, j, k, isa, index, num;
-      int tag;
-
-      int ND = dimension;
-      int N1 = nx;
-      double size = static_cast<double>(N1);
-      int lN1 = local_x;
-      int lxs = local_x_start;
-      int N2 = local_y;
-      int N3 = local_z;
-      int NP = num_planes;
-      int NS = slip_systems;
-      double dslip = material->dslip;
-
-      int NT = solve->max_iter;
-      int NSI = app->stoptime;
-
-      double aa0 = material->aa0;
-      double aa1 = material->aa1;
-      double aa2 = material->aa2;
-      double aa3 = material->aa3;
-      double aa4 = material->aa4;
-      double bb1 = material->bb1;
-      double bb2 = material->bb2;
-      double bb3 = material->bb3;
-      double bb4 = material->bb4;
-      double isf = material->isf;
-      double usf = material->usf;
-      double An = material->An;
-      double Cn = material->Cn;
-      double b = material->b;
-
-      double mu = material->mu;
-      double ll = material->ll;
-      double young = material->young;
-      double xnu = material->xnu;
-
-      aa0 = aa0/(mu*dslip*b);
-      aa1 = aa1/(mu*dslip*b);
-      aa2 = aa2/(mu*dslip*b);
-      aa3 = aa3/(mu*dslip*b);
-      aa4 = aa4/(mu*dslip*b);
-      bb1 = bb1/(mu*dslip*b);
-      bb2 = bb2/(mu*dslip*b);
-      bb3 = bb3/(mu*dslip*b);
-      bb4 = bb4/(mu*dslip*b);
-      isf = isf/(mu*dslip*b);
-      An = An/(mu*dslip*b);
-      Cn = (usf - (isf/2.0))/(mu*dslip*b);
-
-      for(isa=0;isa<NS;isa++){
-        for(i=0;i<lN1;i++)
-        for(j=0;j<N2;j++)
-        for(k=0;k<N3;k++){
-          index = i*N2*N3 + j*N3 + k + isa*lN1*N2*N3;
-          fcore[index] = (aa0 +aa1*cos(2.0*M_PI*data_fftw[index].re)+bb1*sin(2.0*M_PI*data_fftw[index].re)+aa2*cos(4.0*M_PI*data_fftw[index].re)+bb2*sin(4.0*M_PI*data_fftw[index].re)+aa3*cos(6.0*M_PI*data_fftw[index].re)+bb3*sin(6.0*M_PI*data_fftw[index].re)+aa4*cos(8.0*M_PI*data_fftw[index].re)+bb4*sin(8.0*M_PI*data_fftw[index].re));
-
-          MPI_Reduce(&fcore[index], &f_core[index], 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
-        }/*ijk*/
-
-        dE_core[index] = ((2.0*M_PI)*(bb1*cos(2.0*M_PI*data_fftw[index].re)-aa1*sin(2.0*M_PI*data_fftw[index].re))+(4.0*M_PI)*(bb2*cos(4.0*M_PI*data_fftw[index].re)-aa2*sin(4.0*M_PI*data_fftw[index].re))+(6.0*M_PI)*(bb3*cos(6.0*M_PI*data_fftw[index].re)-aa3*sin(6.0*M_PI*data_fftw[index].re))+(8.0*M_PI)*(bb4*cos(8.0*M_PI*data_fftw[index].re)-aa4*sin(8.0*M_PI*data_fftw[index].re)));
-      }/*isa*/
-    }
-
-    /*----------------------------------------
-    The stress-state dependet USFE magnitude: USFE(MRSSP angle X, shear stress tau)
-    -----------------------------------------*/
-    /* added by Hyojung 12/2020*/
-
-    void FFTW_Slab::core_energy_USFE_angle_tau()
-    {
-      int i, j, k, isa, index, num;
-      int tag;
-      int N1 = nx;
-      double size = static_cast<double>(N1);
-      int lN1 = local_x;
-      int lxs = local_x_start;
-      int N2 = local_y;
-      int N3 = local_z;
-      int NS = slip_systems;
-      double dslip = material->dslip;
-      double usf = material->usf;
-      double An ;
-      double b = material->b;
-      double mu = material->mu;
-
-      double a_slope = material->a_slope;
-      double a_b = material->a_b;
-      double b_b = material->b_b;
-      double c_slope= material->c_slope;
-      double c_b = material->c_b;
-      double angle_to_110 = app->angle_to_110;
-
-      double gsfe_max = (a_slope*sigma_rot[2][1]*mu*1.0E-9+a_b)*sin(b_b*angle_to_110*M_PI/180.)+(c_slope*sigma_rot[2][1]*mu*1.0E-9+c_b) ;
-      //  An = usf/(mu*dslip*b);
-      gsfe_max = gsfe_max*1.0E-3;  // unit: mJ/m^2 to J/m^
-      An = gsfe_max/(mu*dslip*b);
-
-      if(me==0){
-        if (logfile) fprintf(logfile,"core flag=6, usfe(angle,tau): %lf\n", gsfe_max);
-        if (logfile) fprintf(logfile,"sigma: %lf, angle_to_110: %lf\n", sigma_rot[1][2], angle_to_110);
-      }
-
-      E_core = 0;
-
-      for(isa=0;isa<NS;isa++){
-        for(i=0;i<lN1;i++)
-        for(j=0;j<N2;j++)
-        for(k=0;k<N3;k++){
-          index = i*N2*N3 + j*N3 + k + isa*lN1*N2*N3;
-          E_core += An*(sin(M_PI*data_fftw[index].re)*sin(M_PI*data_fftw[index].re))/N1;   //To make it general fft->data_fftw has to be general
-          dE_core[index] = An*M_PI*sin(2.0*M_PI*data_fftw[index].re);
-        }/*ijk*/
-      }/*isa*/
-    }
-
-    /* -----------------------------------------------------------------------
-    Project core energy for output
-    ---------------------------------------------------------------------*/
-    void FFTW_Slab::project_core_energy()
-    {
-      int index, index1, index2, index3, indexdx;
-      int counter, marker, indexmin, tag, countSF, cSF, count;
-      double dx, mpidel, p, totAR, sfAR;
-      MPI_Status status;
-      int ND = dimension;
-      int N1 = nx;
-      double size = static_cast<double>(nx);
+      double size = static_cast<double>(nx);
       int lN1 = local_x;
       int lxs = local_x_start;
       int N2 = local_y;
@@ -1554,7 +1501,6 @@ void FFTW_Slab::fft_send(void *buf, int count, MPI_Datatype datatype, int dest,
       double b = material->b;
 
       dx = size/N1;
-      tag = 1;
       p = M_PI/(sqrt(3.0)*(b/1.0E-10));
 
       for(int plane=0;plane<NP;plane++){
@@ -1563,7 +1509,7 @@ void FFTW_Slab::fft_send(void *buf, int count, MPI_Datatype datatype, int dest,
         for(int k=0;k<N3;k++){
           if(NS == 1 || NS == 2){
             index = i*N2*N3 + j*N3 + k + plane*lN1*N2*N3;
-            delta[index] = data_fftw[index].re;
+            delta[index] = xi[0][2*index];
           } // NS=1 || 2
           else{
             index = i*N2*N3 + j*N3 + k + plane*lN1*N2*N3;
@@ -1572,43 +1518,43 @@ void FFTW_Slab::fft_send(void *buf, int count, MPI_Datatype datatype, int dest,
             index2 = i*N2*N3 + j*N3 + k + 1*lN1*N2*N3 + plane*lN1*N2*N3*3;
             index3 = i*N2*N3 + j*N3 + k + 2*lN1*N2*N3 + plane*lN1*N2*N3*3;
 
-            delta[index] = (data_fftw[index1].re*xb[0][0] + data_fftw[index2].re*xb[1][0]
-              + data_fftw[index3].re*xb[2][0])*xb[1][0]
-              + (data_fftw[index1].re*xb[0][1] + data_fftw[index2].re*xb[1][1]
-                + data_fftw[index3].re*xb[2][1])*xb[1][1]
-                + (data_fftw[index1].re*xb[0][2] + data_fftw[index2].re*xb[1][2] + data_fftw[index3].re*xb[2][2])*xb[1][2];
+            delta[index] = (xi[0][2*index1]*xb[0][0] + xi[0][2*index2]*xb[1][0]
+              + xi[0][2*index3]*xb[2][0])*xb[1][0]
+              + (xi[0][2*index1]*xb[0][1] + xi[0][2*index2]*xb[1][1]
+                + xi[0][2*index3]*xb[2][1])*xb[1][1]
+                + (xi[0][2*index1]*xb[0][2] + xi[0][2*index2]*xb[1][2] + xi[0][2*index3]*xb[2][2])*xb[1][2];
 
               }
             } //ijk
           }//plane
 
+          // forward difference along x on the mid y,z line of the box, the
+          // first value of each plane on the proc above arrives in dskin
+          // while the interior is done, 0 on the last plane of the box
+
+          int j = ny/2 - local_y_start;
+          int k = nz/2 - local_z_start;
+          if (j < 0 || j >= N2 || k < 0 || k >= N3 || lN1 == 0) return;
+
+          for(int plane=0; plane<NP; plane++)
+            dskin[plane] = delta[j*N3 + k + plane*lN1*N2*N3];
+          if (ndskin_req) MPI_Startall(ndskin_req,dskin_req);
+
           for(int plane=0; plane<NP; plane++){
-            for(int i=0;i<lN1;i++){
-              int j = N2/2;
-              int k = N3/2;
+            for(int i=0;i<lN1-1;i++){
               index = i*N2*N3 + j*N3 + k + plane*lN1*N2*N3;
               indexdx = (i+1)*N2*N3 + j*N3 + k + plane*lN1*N2*N3;
-              if((i+1) == lN1){
-                indexmin = 0*N2*N3 + j*N3 + k + plane*lN1*N2*N3;
-                if(me != 0){
-                  //	  fft_send(&delta[indexmin], 1, MPI_DOUBLE, me-1, tag, MPI_COMM_WORLD);   // This should be a send function in the FFT class particular to the
-                  MPI_Send(&delta[indexmin], 1, MPI_DOUBLE, me-1, tag, MPI_COMM_WORLD);
-                }
-                if((lxs+(i+1)) == N1){
-                  mpidel = delta[index];
-                  ddelta[index] = (mpidel - delta[index])/dx;
-                  break;
-                }
-                //	fft_recv(&mpidel, 1, MPI_DOUBLE, me+1, tag, MPI_COMM_WORLD, status);
-                MPI_Recv(&mpidel, 1, MPI_DOUBLE, me+1, tag, MPI_COMM_WORLD, &status);
-                ddelta[index] = (mpidel - delta[index])/dx;
-              }
-              else{
-                ddelta[index] = (delta[indexdx] - delta[index])/dx;
-              }
+              ddelta[index] = (delta[indexdx] - delta[index])/dx;
             }
           }
 
+          if (ndskin_req) MPI_Waitall(ndskin_req,dskin_req,MPI_STATUSES_IGNORE);
+
+          for(int plane=0; plane<NP; plane++){
+            index = (lN1-1)*N2*N3 + j*N3 + k + plane*lN1*N2*N3;
+            mpidel = (lxs+lN1 == N1) ? delta[index] : dskin[NP+plane];
+            ddelta[index] = (mpidel - delta[index])/dx;
+          }
         }
         /* -----------------------------------------------------------------------
         Initialize inner loop
@@ -1654,38 +1600,81 @@ void FFTW_Slab::fft_send(void *buf, int count, MPI_Datatype datatype, int dest,
         }
         /* -----------------------------------------------------------------------
         Compute Order parameter that minimizes internal energy
+        data_real = BB data_fftw at every k-point, a block of k-points at a
+        time: the inputs of all slip systems are read once into the tile,
+        each stored pair ka <= kb feeds both outputs, data_real written once
+        with matrix_free yes the block's BB is rebuilt first, see bb_block()
         ---------------------------------------------------------------------*/
         void FFTW_Slab::internal_energy()
         {
-          int lN1 = local_x;
-          int N2 = local_y;
-          int N3 = local_z;
           int NS = slip_systems;
-          int index=0, index2=0, nb=0;
+          int DS = total_local_size;
+          int L = local_kn1*local_kn2*local_kz;
+          int isa, isb, q, q0, n, t;
+          double xr[NS][KBLOCK], xim[NS][KBLOCK];
+          double yr[NS][KBLOCK], yim[NS][KBLOCK];
+
+          // pair p of the block is at bb + p*bstride
+          int bstride = matrix_free ? KBLOCK : L;
+
+          for (q0 = 0; q0 < L; q0 += KBLOCK) {
+            n = MIN(KBLOCK, L-q0);
+
+            double *bq;
+            if (matrix_free) {
+              bb_block(q0,n,bbt,KBLOCK);
+              bq = bbt;
+            }
+            else bq = BB + q0;
 
-          for (int i=0; i<lN1*N2*N3*NS; i++){
-            data_real[i].re = 0;
-            data_real[i].im = 0;
-          }
-          for(int isa=0;isa<NS;isa++){
-            for(int isb=0;isb<NS;isb++){
-              for(int i=0;i<lN1;i++)
-              for(int j=0;j<N2;j++)
-              for(int k=0;k<N3;k++){
-                index  = i*N2*N3 + j*N3 + k + isa*lN1*N2*N3;
-                index2 = i*N2*N3 + j*N3 + k + isb*lN1*N2*N3;
-                nb     = i*N2*N3 + j*N3 + k + isa*lN1*N2*N3 + isb*lN1*N2*N3*NS;
-                data_real[index].re += data_fftw[index2].re * BB[nb];
-                data_real[index].im += data_fftw[index2].im * BB[nb];
+            for (isa = 0; isa < NS; isa++) {
+              FFT_DATA *in = data_fftw + isa*DS + q0;
+              for (t = 0; t < n; t++) {
+                xr[isa][t] = in[t].re;
+                xim[isa][t] = in[t].im;
+              }
+            }
+
+            for (isa = 0; isa < NS; isa++) {
+              double *bb = bq + PAIR(isa,isa,NS)*bstride;
+              for (t = 0; t < n; t++) {
+                yr[isa][t] = bb[t]*xr[isa][t];
+                yim[isa][t] = bb[t]*xim[isa][t];
+              }
+            }
+
+            for (isa = 0; isa < NS; isa++)
+              for (isb = isa+1; isb < NS; isb++) {
+                double *bb = bq + PAIR(isa,isb,NS)*bstride;
+                for (t = 0; t < n; t++) {
+                  yr[isa][t] += bb[t]*xr[isb][t];
+                  yim[isa][t] += bb[t]*xim[isb][t];
+                  yr[isb][t] += bb[t]*xr[isa][t];
+                  yim[isb][t] += bb[t]*xim[isa][t];
+                }
+              }
+
+            for (isa = 0; isa < NS; isa++) {
+              FFT_DATA *out = data_real + isa*DS + q0;
+              for (t = 0; t < n; t++) {
+                out[t].re = yr[isa][t];
+                out[t].im = yim[isa][t];
               }
             }
           }
+
+          // the rest of each total_local_size slot is not k-space
+          for (isa = 0; isa < NS; isa++)
+            for (q = L; q < DS; q++) {
+              data_real[q + isa*DS].re = 0;
+              data_real[q + isa*DS].im = 0;
+            }
         }
 
         /* -----------------------------------------------------------------------
-        Update order parameter
+        Update order parameter, explicit step of length dt
         ---------------------------------------------------------------------*/
-        void FFTW_Slab::update_order_parameter()
+        void FFTW_Slab::update_order_parameter(double dt)
         {
           int lN1 = local_x;
           int N1 = nx;
@@ -1696,7 +1685,14 @@ void FFTW_Slab::fft_send(void *buf, int count, MPI_Datatype datatype, int dest,
           double xinormlocal=0.0;           // stores the norm of the increment of xi
           double xirep=0.0, xiimp=0.0;      // store previous re and im values of xi
           double xi_ave=0.0;                // Local average of the order parameter
-          int nsize = N1*N2*N3;
+          int nsize = N1*ny*nz;
+          double *rdata = (double *) data_real;  // r2c: padded real rows of 2*local_kz
+          int NK2 = 2*local_kz;
+          int DS = total_local_size;
+          int nr = 0, nd = 0;
+          // on a grid coarser by h the elastic interaction weighs 1/h
+          // against the core energy and the applied stress
+          double ncell = nsize*hgrid;
 
           for(int isa=0;isa<NS;isa++){
             for(int i=0;i<lN1;i++){
@@ -1704,16 +1700,25 @@ void FFTW_Slab::fft_send(void *buf, int count, MPI_Datatype datatype, int dest,
                 for(int k=0;k<N3;k++){
                   na0 = 2*(i*N2*N3 + j*N3 + k + isa*lN1*N2*N3);
                   index = i*N2*N3 + j*N3 + k + isa*lN1*N2*N3;
+                  nd = i*N2*N3 + j*N3 + k + isa*DS;
                   na = 2*(i*N2*N3 + j*N3 + k);
                   na1 = na0+1;
 
                   //Ginzburg-Landau Equation for real and imag parts
+                  // with glide planes xi stays zero off them
 
-                  if(xo[index] == 0.0){
+                  if(xo[index] == 0.0 && (zactive == NULL || zactive[k])){
                     xirep = xi[0][na0];
                     xiimp = xi[0][na1];
-                    xi[0][na0] = xi[0][na0]-((app->CD*app->timestep)*(data_real[index].re/(nsize) - tau[isa] + dE_core[index]));
-                    xi[0][na1] = xi[0][na1]-((app->CD*app->timestep)*(data_real[index].im/(nsize)));
+                    if (r2c) {
+                      // imaginary part stays zero
+                      nr = i*N2*NK2 + j*NK2 + k + 2*isa*DS;
+                      xi[0][na0] = xi[0][na0]-((app->CD*dt)*(rdata[nr]/(ncell) - tau[isa] + dE_core[index]));
+                    }
+                    else {
+                    xi[0][na0] = xi[0][na0]-((app->CD*dt)*(data_real[nd].re/(ncell) - tau[isa] + dE_core[index]));
+                    xi[0][na1] = xi[0][na1]-((app->CD*dt)*(data_real[nd].im/(ncell)));
+                    }
                     xi_sum[0][na] += xi[0][na0];
                     xi_sum[0][na+1] += xi[0][na1];
                   }
@@ -1726,10 +1731,607 @@ void FFTW_Slab::fft_send(void *buf, int count, MPI_Datatype datatype, int dest,
               }
             }
           }
-          MPI_Allreduce(&xi_ave, &xiave, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
-          MPI_Allreduce(&xinormlocal, &xinorm, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
-          xinorm = sqrt(xinorm);
+          // both sums in one reduction, none on steps the solver does
+          // not check
+          if (check_norm) {
+            double sum[2] = {xi_ave, xinormlocal}, sumall[2];
+            MPI_Allreduce(sum, sumall, 2, MPI_DOUBLE, MPI_SUM, world);
+            xiave = sumall[0];
+            xinorm = sqrt(sumall[1]);
+          }
+        }
+        /* -----------------------------------------------------------------------
+        Semi-implicit Ginzburg-Landau step, see solve_style GL_semi_implicit
+        xi_new = xi - cdt (B xi_new + S xi_new - tau + dE_core - S xi) with
+        cdt = CD*dt and S = stab: the explicit part goes into data_fftw here,
+        the FFT of xi_new is found at each k-point by implicit_solve() and
+        read back into xi after the backward FFT; points with xo != 0 keep
+        their xi as in the explicit step
+        ---------------------------------------------------------------------*/
+        void FFTW_Slab::prepare_semi_implicit(double cdt, double stab)
+        {
+          int lN1 = local_x;
+          int N2 = local_y;
+          int N3 = local_z;
+          int NS = slip_systems;
+          int DS = total_local_size;
+          int NK2 = 2*local_kz;
+          double *rdata = (double *) data_fftw;
+          int index, na0, nd;
+          double re;
+
+          // replaces what sweep() left in data_fftw, xi or its spectrum
+          spectrum_ready = 0;
+
+          for(int isa=0;isa<NS;isa++){
+            for(int i=0;i<lN1;i++){
+              for(int j=0;j<N2;j++){
+                for(int k=0;k<N3;k++){
+                  na0 = 2*(i*N2*N3 + j*N3 + k + isa*lN1*N2*N3);
+                  index = i*N2*N3 + j*N3 + k + isa*lN1*N2*N3;
+
+                  re = (1.0 + cdt*stab)*xi[0][na0];
+                  if(xo[index] == 0.0)
+                    re -= cdt*(dE_core[index] - tau[isa]);
+
+                  if (r2c)
+                    rdata[i*N2*NK2 + j*NK2 + k + 2*isa*DS] = re;
+                  else {
+                    nd = i*N2*N3 + j*N3 + k + isa*DS;
+                    data_fftw[nd].re = re;
+                    data_fftw[nd].im = (1.0 + cdt*stab)*xi[0][na0+1];
+                  }
+                }
+              }
+            }
+          }
         }
+
+        /* -----------------------------------------------------------------------
+        Solve ((1 + cdt S) I + cdt BB) x = data_fftw at every k-point, BB is
+        symmetric positive semi-definite so the NS x NS system is done by
+        Cholesky
+        x goes to data_fftw, for the strain, and to data_real for the
+        backward FFT; the blocks of k-points are those of internal_energy()
+        ---------------------------------------------------------------------*/
+        void FFTW_Slab::implicit_solve(double cdt, double stab)
+        {
+          int NS = slip_systems;
+          int DS = total_local_size;
+          int L = local_kn1*local_kn2*local_kz;
+          int isa, isb, isc, q, q0, n, t;
+          double s;
+
+          // m_ab at m[a*NS + b], the right hand sides xr and xim after it
+          double *m = chol;
+          double *xr = chol + NS*NS;
+          double *xim = xr + NS;
+
+          int bstride = matrix_free ? KBLOCK : L;
+
+          for (q0 = 0; q0 < L; q0 += KBLOCK) {
+            n = MIN(KBLOCK, L-q0);
+
+            double *bq;
+            if (matrix_free) {
+              bb_block(q0,n,bbt,KBLOCK);
+              bq = bbt;
+            }
+            else bq = BB + q0;
+
+            for (t = 0; t < n; t++) {
+              q = q0 + t;
+
+              // lower triangle of the matrix, overwritten by its factor
+              for (isa = 0; isa < NS; isa++) {
+                for (isb = 0; isb <= isa; isb++)
+                  m[isa*NS + isb] = cdt*bq[PAIR(isb,isa,NS)*bstride + t];
+                m[isa*NS + isa] += 1.0 + cdt*stab;
+                xr[isa] = data_fftw[q + isa*DS].re;
+                xim[isa] = data_fftw[q + isa*DS].im;
+              }
+
+              for (isa = 0; isa < NS; isa++) {
+                s = m[isa*NS + isa];
+                for (isc = 0; isc < isa; isc++) s -= m[isa*NS + isc]*m[isa*NS + isc];
+                if (s <= 0.0)
+                  error->one(FLERR,"Semi-implicit matrix is not positive definite");
+                m[isa*NS + isa] = sqrt(s);
+                for (isb = isa+1; isb < NS; isb++) {
+                  s = m[isb*NS + isa];
+                  for (isc = 0; isc < isa; isc++) s -= m[isb*NS + isc]*m[isa*NS + isc];
+                  m[isb*NS + isa] = s/m[isa*NS + isa];
+                }
+              }
+
+              // forward then back substitution, real and imaginary parts
+              for (isa = 0; isa < NS; isa++) {
+                for (isc = 0; isc < isa; isc++) {
+                  xr[isa] -= m[isa*NS + isc]*xr[isc];
+                  xim[isa] -= m[isa*NS + isc]*xim[isc];
+                }
+                xr[isa] /= m[isa*NS + isa];
+                xim[isa] /= m[isa*NS + isa];
+              }
+              for (isa = NS-1; isa >= 0; isa--) {
+                for (isc = isa+1; isc < NS; isc++) {
+                  xr[isa] -= m[isc*NS + isa]*xr[isc];
+                  xim[isa] -= m[isc*NS + isa]*xim[isc];
+                }
+                xr[isa] /= m[isa*NS + isa];
+                xim[isa] /= m[isa*NS + isa];
+              }
+
+              for (isa = 0; isa < NS; isa++) {
+                data_fftw[q + isa*DS].re = data_real[q + isa*DS].re = xr[isa];
+                data_fftw[q + isa*DS].im = data_real[q + isa*DS].im = xim[isa];
+              }
+            }
+          }
+
+          // the rest of each total_local_size slot is not k-space
+          for (isa = 0; isa < NS; isa++)
+            for (q = L; q < DS; q++) {
+              data_real[q + isa*DS].re = 0;
+              data_real[q + isa*DS].im = 0;
+            }
+        }
+
+        /* -----------------------------------------------------------------------
+        Update order parameter from the backward FFT of the implicit solve
+        ---------------------------------------------------------------------*/
+        void FFTW_Slab::update_order_parameter_implicit()
+        {
+          int lN1 = local_x;
+          int N2 = local_y;
+          int N3 = local_z;
+          int NS = slip_systems;
+          int index=0, na=0, na0=0, na1=0;
+          double xinormlocal=0.0;           // stores the norm of the increment of xi
+          double xirep=0.0, xiimp=0.0;      // store previous re and im values of xi
+          double xi_ave=0.0;                // Local average of the order parameter
+          int nsize = nx*ny*nz;
+          double *rdata = (double *) data_real;
+          int NK2 = 2*local_kz;
+          int DS = total_local_size;
+          int nr = 0, nd = 0;
+
+          for(int isa=0;isa<NS;isa++){
+            for(int i=0;i<lN1;i++){
+              for(int j=0;j<N2;j++){
+                for(int k=0;k<N3;k++){
+                  na0 = 2*(i*N2*N3 + j*N3 + k + isa*lN1*N2*N3);
+                  index = i*N2*N3 + j*N3 + k + isa*lN1*N2*N3;
+                  nd = i*N2*N3 + j*N3 + k + isa*DS;
+                  na = 2*(i*N2*N3 + j*N3 + k);
+                  na1 = na0+1;
+
+                  xirep = xi[0][na0];
+                  xiimp = xi[0][na1];
+                  if(xo[index] == 0.0){
+                    if (r2c) {
+                      nr = i*N2*NK2 + j*NK2 + k + 2*isa*DS;
+                      xi[0][na0] = rdata[nr]/nsize;
+                    }
+                    else {
+                      xi[0][na0] = data_real[nd].re/nsize;
+                      xi[0][na1] = data_real[nd].im/nsize;
+                    }
+                    xi_sum[0][na] += xi[0][na0];
+                    xi_sum[0][na+1] += xi[0][na1];
+                  }
+                  xinormlocal += (xi[0][na0] - xirep)*(xi[0][na0] - xirep) +
+                  (xi[0][na1] - xiimp)*(xi[0][na1] - xiimp);
+                  xi_ave += xi[0][na0];
+                }
+              }
+            }
+          }
+          // both sums in one reduction, none on steps the solver does
+          // not check
+          if (check_norm) {
+            double sum[2] = {xi_ave, xinormlocal}, sumall[2];
+            MPI_Allreduce(sum, sumall, 2, MPI_DOUBLE, MPI_SUM, world);
+            xiave = sumall[0];
+            xinorm = sqrt(sumall[1]);
+          }
+        }
+        /* -----------------------------------------------------------------------
+        GL rate of each xi value, f = -CD dE/dxi laid out as xi, from the
+        forces left by internal_energy() and the backward FFT; 0 where xi
+        is held: obstacles, off the glide planes and the r2c imaginary part
+        ---------------------------------------------------------------------*/
+        void FFTW_Slab::xi_force(double *f)
+        {
+          int lN1 = local_x;
+          int N2 = local_y;
+          int N3 = local_z;
+          int NS = slip_systems;
+          int nsize = nx*ny*nz;
+          double *rdata = (double *) data_real;
+          int NK2 = 2*local_kz;
+          int DS = total_local_size;
+          int index, na0, nd;
+          double cd = app->CD;
+
+          for(int isa=0;isa<NS;isa++){
+            for(int i=0;i<lN1;i++){
+              for(int j=0;j<N2;j++){
+                for(int k=0;k<N3;k++){
+                  na0 = 2*(i*N2*N3 + j*N3 + k + isa*lN1*N2*N3);
+                  index = i*N2*N3 + j*N3 + k + isa*lN1*N2*N3;
+                  nd = i*N2*N3 + j*N3 + k + isa*DS;
+
+                  f[na0] = f[na0+1] = 0.0;
+                  if(xo[index] == 0.0 && (zactive == NULL || zactive[k])){
+                    if (r2c)
+                      f[na0] = -cd*(rdata[i*N2*NK2 + j*NK2 + k + 2*isa*DS]/nsize - tau[isa] + dE_core[index]);
+                    else {
+                      f[na0] = -cd*(data_real[nd].re/nsize - tau[isa] + dE_core[index]);
+                      f[na0+1] = -cd*data_real[nd].im/nsize;
+                    }
+                  }
+                }
+              }
+            }
+          }
+        }
+
+        /* -----------------------------------------------------------------------
+        # of sites of each slip system the GL update moves, summed over
+        the procs: not an obstacle and, with glide planes, on one of them
+        ---------------------------------------------------------------------*/
+        void FFTW_Slab::mobile_sites(double *nmobile)
+        {
+          int lN1 = local_x;
+          int N2 = local_y;
+          int N3 = local_z;
+          int NS = slip_systems;
+          int index;
+          double *nlocal;
+
+          memory->create(nlocal,NS,"fft:nlocal");
+
+          for(int isa=0;isa<NS;isa++){
+            nlocal[isa] = 0.0;
+            for(int i=0;i<lN1;i++)
+              for(int j=0;j<N2;j++)
+                for(int k=0;k<N3;k++){
+                  index = i*N2*N3 + j*N3 + k + isa*lN1*N2*N3;
+                  if(xo[index] == 0.0 && (zactive == NULL || zactive[k]))
+                    nlocal[isa] += 1.0;
+                }
+          }
+          MPI_Allreduce(nlocal,nmobile,NS,MPI_DOUBLE,MPI_SUM,world);
+          memory->destroy(nlocal);
+        }
+
+        /* -----------------------------------------------------------------------
+        xi and xo of the grid coarser by f, by taking every f-th site, kept
+        in lvl_buf for load_xi() after regrid(): the coarse x planes inside
+        this proc's slab, field isa holds xi and field NS+isa holds xo
+        ---------------------------------------------------------------------*/
+        void FFTW_Slab::restrict_xi(int f)
+        {
+          int lN1 = local_x;
+          int lxs = local_x_start;
+          int N2 = local_y;
+          int N3 = local_z;
+          int NS = slip_systems;
+          int i, j, k, index, m, size;
+
+          lvl_lo = (lxs+f-1)/f;
+          lvl_n = (lxs+lN1+f-1)/f - lvl_lo;
+          lvl_dim[0] = lvl_n;
+          lvl_dim[1] = ny/f;
+          lvl_dim[2] = nz/f;
+          size = lvl_n*lvl_dim[1]*lvl_dim[2];
+
+          memory->destroy(lvl_buf);
+          memory->create(lvl_buf,MAX(2*NS*size,1),"fft:lvl_buf");
+
+          for(int isa=0;isa<NS;isa++)
+            for(i=0;i<lN1;i++){
+              if ((lxs+i) % f) continue;
+              for(j=0;j<N2;j+=f)
+                for(k=0;k<N3;k+=f){
+                  index = i*N2*N3 + j*N3 + k + isa*lN1*N2*N3;
+                  m = (((lxs+i)/f - lvl_lo)*lvl_dim[1] + j/f)*lvl_dim[2] + k/f;
+                  lvl_buf[m + isa*size].re = xi[0][2*index];
+                  lvl_buf[m + isa*size].im = xi[0][2*index+1];
+                  lvl_buf[m + (NS+isa)*size].re = xo[index];
+                  lvl_buf[m + (NS+isa)*size].im = 0.0;
+                }
+            }
+        }
+
+        /* -----------------------------------------------------------------------
+        planes lo to lo+n-1 along the slab axis of the nf fields of lvl_buf
+        into out, each plane from the proc that holds it, then frees lvl_buf
+        the other two extents of out are those of lvl_buf
+        ---------------------------------------------------------------------*/
+        void FFTW_Slab::level_remap(FFT_DATA *out, int nf, int lo, int n)
+        {
+          int mine[4] = {lvl_lo, lvl_n, lo, n};
+          int outdim[3] = {n, lvl_dim[1], lvl_dim[2]};
+          int *range, *alo, *an, *blo, *bn;
+          int p, a, b, nsend, nrecv;
+          FFT_DATA *sbuf = sendbuf, *rbuf = recvbuf;
+          Remap rm;
+
+          memory->create(range,4*nprocs,"fft:range");
+          memory->create(alo,nprocs,"fft:alo");
+          memory->create(an,nprocs,"fft:an");
+          memory->create(blo,nprocs,"fft:blo");
+          memory->create(bn,nprocs,"fft:bn");
+          MPI_Allgather(mine,4,MPI_INT,range,4,MPI_INT,world);
+
+          // planes held here that p wants, planes wanted here that p holds
+
+          for (p = 0; p < nprocs; p++) {
+            a = MAX(lvl_lo,range[4*p+2]);
+            b = MIN(lvl_lo+lvl_n,range[4*p+2]+range[4*p+3]);
+            alo[p] = b > a ? a - lvl_lo : 0;
+            an[p] = b > a ? b - a : 0;
+            a = MAX(range[4*p],lo);
+            b = MIN(range[4*p]+range[4*p+1],lo+n);
+            blo[p] = b > a ? a - lo : 0;
+            bn[p] = b > a ? b - a : 0;
+          }
+          remap_setup(rm,world,lvl_dim,outdim,0,0,alo,an,blo,bn);
+
+          // the messages are sized for these grids, not for the all-to-all
+          // buffers of the style
+
+          nsend = nrecv = 0;
+          for (p = 0; p < nprocs; p++) {
+            nsend += nf*rm.sendcnt[p]/2;
+            nrecv += nf*rm.recvcnt[p]/2;
+          }
+          memory->create(sendbuf,MAX(nsend,1),"fft:sendbuf");
+          memory->create(recvbuf,MAX(nrecv,1),"fft:recvbuf");
+          remap(lvl_buf,out,nf,rm);
+          memory->destroy(sendbuf);
+          memory->destroy(recvbuf);
+          sendbuf = sbuf;
+          recvbuf = rbuf;
+
+          remap_destroy(rm);
+          memory->destroy(range);
+          memory->destroy(alo);
+          memory->destroy(an);
+          memory->destroy(blo);
+          memory->destroy(bn);
+          memory->destroy(lvl_buf);
+          lvl_buf = NULL;
+        }
+
+        /* -----------------------------------------------------------------------
+        xi and xo of the local sites of this grid from restrict_xi()
+        ---------------------------------------------------------------------*/
+        void FFTW_Slab::load_xi()
+        {
+          int NS = slip_systems;
+          int size = local_x*local_y*local_z;
+          int index, m;
+          FFT_DATA *g;
+
+          memory->create(g,MAX(2*NS*size,1),"fft:g");
+          level_remap(g,2*NS,local_x_start,local_x);
+
+          for(int isa=0;isa<NS;isa++)
+            for(m=0;m<size;m++){
+              index = m + isa*size;
+              xi[0][2*index] = g[index].re;
+              xi[0][2*index+1] = g[index].im;
+              xo[index] = g[m + (NS+isa)*size].re;
+            }
+
+          memory->destroy(g);
+        }
+
+        /* -----------------------------------------------------------------------
+        unnormalized Fourier coefficients of xi, the k-space planes of this
+        proc kept in lvl_buf for prolongate_xi() after regrid(), planes are
+        kx, or ky when k-space is transposed; leaves k-space in data_fftw
+        ---------------------------------------------------------------------*/
+        void FFTW_Slab::spectrum_xi()
+        {
+          int NS = slip_systems;
+          int DS = total_local_size;
+          int L = local_kn1*local_kn2*local_kz;
+
+          prepare_next_itr();
+          prep_forward();
+
+          lvl_lo = kspace_transposed ? local_y_start_after_trans : local_x_start;
+          lvl_n = local_kn1;
+          lvl_dim[0] = local_kn1;
+          lvl_dim[1] = local_kn2;
+          lvl_dim[2] = local_kz;
+
+          memory->destroy(lvl_buf);
+          memory->create(lvl_buf,MAX(NS*L,1),"fft:lvl_buf");
+          for(int isa=0;isa<NS;isa++)
+            for(int q=0;q<L;q++)
+              lvl_buf[q + isa*L] = data_fftw[q + isa*DS];
+        }
+
+        /* -----------------------------------------------------------------------
+        frequency kf of a grid of n points as frequency kc of a grid of
+        nc <= n, returns the weight of that coefficient: 0 if kf is above
+        the coarse band, 1/2 at the two aliases of an even coarse Nyquist
+        ---------------------------------------------------------------------*/
+        static double coarse_mode(int kf, int n, int nc, int &kc)
+        {
+          int h = nc/2;
+
+          kc = kf;
+          if (nc == n) return 1.0;
+          if (kf < h || (nc % 2 && kf == h)) return 1.0;
+          kc = kf - n + nc;
+          if (kf > n-h || (nc % 2 && kf == n-h)) return 1.0;
+          kc = h;
+          if (nc % 2 == 0 && (kf == h || kf == n-h)) return 0.5;
+          return 0.0;
+        }
+
+        /* -----------------------------------------------------------------------
+        planes h.i = const of grid indices i normal to v, v the slip plane
+        normal along the three grid steps; h is the smallest integer normal,
+        returns the spacing in h.i of the planes through the sites of a grid
+        coarser by fc[d] along d, 0 if v has no small integer normal
+        ---------------------------------------------------------------------*/
+        static int plane_period(double *v, int *fc, int *h)
+        {
+          double vmin = 0.0;
+          double a;
+          int d, mult, p, q, r;
+
+          for (d = 0; d < 3; d++)
+            if (fabs(v[d]) > 1.0e-8 && (vmin == 0.0 || fabs(v[d]) < vmin))
+              vmin = fabs(v[d]);
+          if (vmin == 0.0) return 0;
+
+          for (mult = 1; mult <= 12; mult++) {
+            for (d = 0; d < 3; d++) {
+              a = mult*v[d]/vmin;
+              h[d] = static_cast<int>(floor(a + 0.5));
+              if (fabs(a - h[d]) > 1.0e-6) break;
+            }
+            if (d == 3) break;
+          }
+          if (mult > 12) return 0;
+
+          p = 0;
+          for (d = 0; d < 3; d++) {
+            q = h[d] < 0 ? -h[d]*fc[d] : h[d]*fc[d];
+            while (q) {
+              r = p % q;
+              p = q;
+              q = r;
+            }
+          }
+          return p;
+        }
+
+        /* -----------------------------------------------------------------------
+        xi from the spectrum of an n1 x n2 x n3 grid of the same box, as
+        made by spectrum_xi(), zero-padded to this grid
+        slip is a layer one site thick, interpolated across it would spread
+        over the planes between the coarse ones: each slip system is only
+        updated on its glide planes through the coarse sites, found from
+        its slip plane normal, sites between them and sites with an obstacle
+        keep their xi
+        ---------------------------------------------------------------------*/
+        void FFTW_Slab::prolongate_xi(int n1, int n2, int n3)
+        {
+          int lN1 = local_x;
+          int lxs = local_x_start;
+          int N2 = local_y;
+          int N3 = local_z;
+          int NS = slip_systems;
+          int DS = total_local_size;
+          int NK2 = 2*local_kz;
+          double *rdata = (double *) data_real;
+          double ncoarse = static_cast<double>(n1)*n2*n3;
+          int fc[3] = {nx/n1, ny/n2, nz/n3};
+          int ns = kspace_transposed ? ny : nx;
+          int nc = kspace_transposed ? n2 : n1;
+          int s0 = kspace_transposed ? local_y_start_after_trans : local_x_start;
+          int d1 = lvl_dim[1];
+          int d2 = lvl_dim[2];
+          int i, j, k, d, gx, gy, cx, cy, cz, cs, nf, m, index, na0;
+          int lo, hi, size, *hn, *period;
+          double w, v[3];
+          FFT_DATA *g;
+
+          // coarse planes along the slab axis the modes of this proc come
+          // from, a contiguous range
+
+          lo = nc;
+          hi = -1;
+          for(i=0;i<local_kn1;i++)
+            if (coarse_mode(s0+i,ns,nc,cs) != 0.0) {
+              lo = MIN(lo,cs);
+              hi = MAX(hi,cs);
+            }
+          if (hi < lo) {
+            lo = 0;
+            hi = -1;
+          }
+          size = (hi-lo+1)*d1*d2;
+          memory->create(g,MAX(NS*size,1),"fft:g");
+          level_remap(g,NS,lo,hi-lo+1);
+
+          for(i=0;i<local_kn1;i++)
+            for(j=0;j<local_kn2;j++)
+              for(k=0;k<local_kz;k++){
+                nf = k + j*local_kz + i*local_kz*local_kn2;
+                if (kspace_transposed) {
+                  gx = j;
+                  gy = s0+i;
+                }
+                else {
+                  gx = s0+i;
+                  gy = local_y_start+j;
+                }
+                w = coarse_mode(gx,nx,n1,cx)*coarse_mode(gy,ny,n2,cy)*
+                  coarse_mode(local_z_start+k,nz,n3,cz);
+                if (kspace_transposed) m = ((cy-lo)*d1 + cx)*d2 + cz;
+                else m = ((cx-lo)*d1 + cy)*d2 + cz;
+                for(int isa=0;isa<NS;isa++){
+                  data_real[nf + isa*DS].re = w == 0.0 ? 0.0 : w*g[m + isa*size].re;
+                  data_real[nf + isa*DS].im = w == 0.0 ? 0.0 : w*g[m + isa*size].im;
+                }
+              }
+          for(int isa=0;isa<NS;isa++)
+            for(int q=local_kn1*local_kn2*local_kz;q<DS;q++){
+              data_real[q + isa*DS].re = 0.0;
+              data_real[q + isa*DS].im = 0.0;
+            }
+          memory->destroy(g);
+
+          prep_backward();
+
+          // glide planes of each slip system in grid indices, the normal
+          // along the grid steps, the columns of sclprim
+
+          memory->create(hn,3*NS,"fft:hn");
+          memory->create(period,NS,"fft:period");
+          for(int isa=0;isa<NS;isa++){
+            for (d = 0; d < 3; d++)
+              v[d] = xn[isa][0]*sclprim[0][d] + xn[isa][1]*sclprim[1][d] +
+                xn[isa][2]*sclprim[2][d];
+            period[isa] = plane_period(v,fc,&hn[3*isa]);
+          }
+
+          for(int isa=0;isa<NS;isa++)
+            for(i=0;i<lN1;i++)
+              for(j=0;j<N2;j++)
+                for(k=0;k<N3;k++){
+                  index = i*N2*N3 + j*N3 + k + isa*lN1*N2*N3;
+                  if (xo[index] != 0.0) continue;
+                  if (period[isa] &&
+                      (hn[3*isa]*(lxs+i) + hn[3*isa+1]*(local_y_start+j) +
+                       hn[3*isa+2]*(local_z_start+k)) % period[isa]) continue;
+                  na0 = 2*index;
+                  if (r2c) {
+                    xi[0][na0] = rdata[i*N2*NK2 + j*NK2 + k + 2*isa*DS]/ncoarse;
+                    xi[0][na0+1] = 0.0;
+                  }
+                  else {
+                    xi[0][na0] = data_real[i*N2*N3 + j*N3 + k + isa*DS].re/ncoarse;
+                    xi[0][na0+1] = data_real[i*N2*N3 + j*N3 + k + isa*DS].im/ncoarse;
+                  }
+                }
+
+          memory->destroy(hn);
+          memory->destroy(period);
+
+          prepare_next_itr();
+        }
+
         /* ------------------------------------------------------------------
         Prepares the next iteration
         ------------------------------------------------------------------ */
@@ -1742,12 +2344,29 @@ void FFTW_Slab::fft_send(void *buf, int count, MPI_Datatype datatype, int dest,
           int NS = slip_systems;
           int index=0, na=0, na0=0, na1=0;
 
+          // the glide plane transform reads xi itself
+          if (zactive) return;
+
+          if (r2c) {
+            // real xi into the padded rows r2c transforms in place
+            double *rdata = (double *) data_fftw;
+            int NK2 = 2*local_kz;
+            for(int isa=0;isa<NS;isa++)
+              for(int i=0;i<lN1;i++)
+                for(int j=0;j<N2;j++)
+                  for(int k=0;k<N3;k++){
+                    na0 = 2*(i*N2*N3 + j*N3 + k + isa*lN1*N2*N3);
+                    rdata[i*N2*NK2 + j*NK2 + k + 2*isa*total_local_size] = xi[0][na0];
+                  }
+            return;
+          }
+
           for(int isa=0;isa<NS;isa++){
             for(int i=0;i<lN1;i++){
               for(int j=0;j<N2;j++){
                 for(int k=0;k<N3;k++){
                   na0 = 2*(i*N2*N3 + j*N3 + k + isa*lN1*N2*N3);
-                  index = i*N2*N3 + j*N3 + k + isa*lN1*N2*N3;
+                  index = i*N2*N3 + j*N3 + k + isa*total_local_size;
                   na = 2*(i*N2*N3 + j*N3 + k);
                   na1 = na0+1;
                   data_fftw[index].re = xi[0][na0];
@@ -1802,7 +2421,11 @@ void FFTW_Slab::fft_send(void *buf, int count, MPI_Datatype datatype, int dest,
         ------------------------------------------------------------------ */
         void FFTW_Slab::prep_forward()
         {
-          if(mode == 1)
+          if(spectrum_ready)
+          spectrum_ready = 0;
+          else if(zactive)
+          glide_transform(0);
+          else if(mode == 1)
           forward_mode1();
           else if(mode == 2)
           forward_mode2();
@@ -1813,104 +2436,71 @@ void FFTW_Slab::fft_send(void *buf, int count, MPI_Datatype datatype, int dest,
         ------------------------------------------------------------------ */
         void FFTW_Slab::prep_backward()
         {
-          if(mode == 1)
+          if(zactive)
+          glide_transform(1);
+          else if(mode == 1)
           backward_mode1();
           else if(mode == 2)
           backward_mode2();
         }
 
-
-        /* -----------------------------------------------------------------------
-        forward FFT
-        ---------------------------------------------------------------------*/
-        void FFTW_Slab::forward_mode1()
-        {
-          int lN1 = local_x;
-          int N2 = local_y;
-          int N3 = local_z;
-          int NS = slip_systems;
-
-          for(int i=0; i<NS; i++){
-            int psys = i*lN1*N2*N3;
-            fftwnd_mpi(plan, 1, data_fftw+psys, work, FFTW_NORMAL_ORDER);
-          }
-        }
-
-        /* -----------------------------------------------------------------------
-        forward FFT
-        ---------------------------------------------------------------------*/
-        void FFTW_Slab::forward_mode2()
-        {
-          int lN1 = local_x;
-          int N2 = local_y;
-          int N3 = local_z;
-          int NS = slip_systems;
-          int index = -1, index2 = -1;
-
-
-          for(int isa=0;isa<NS;isa++){
-            for(int ii=0;ii<total_local_size;ii++){
-              index = isa + ii*NS;
-              index2 = ii + isa*total_local_size;
-              temp_data[index] = data_fftw[index2];
-            }
-          }
-          fftwnd_mpi(plan,NS,temp_data,work,FFTW_NORMAL_ORDER);
-
-          for(int isa=0;isa<NS;isa++){
-            for(int ii=0;ii<total_local_size;ii++){
-              index = isa + ii*NS;
-              index2 = ii + isa*total_local_size;
-              data_fftw[index2] = temp_data[index];
-            }
-          }
-        }
-
+
+#ifndef FFT_FFTW3
+
         /* -----------------------------------------------------------------------
-        backward FFT
+        forward FFT
+        on more than one proc k-space is left in transposed order, saving
+        the transpose back to x slabs here and the one to y slabs backward
         ---------------------------------------------------------------------*/
-        void FFTW_Slab::backward_mode1()
+        void FFTW_Slab::forward_mode1()
         {
-          int lN1 = local_x;
-          int N2 = local_y;
-          int N3 = local_z;
           int NS = slip_systems;
+          fftwnd_mpi_output_order order =
+            kspace_transposed ? FFTW_TRANSPOSED_ORDER : FFTW_NORMAL_ORDER;
+
+          if (r2c) {
+            for(int i=0; i<NS; i++){
+              int psys = i*total_local_size;
+              rfftwnd_mpi(rplan, 1, (fftw_real *) (data_fftw+psys),
+                (fftw_real *) work, order);
+            }
+            return;
+          }
 
           for(int i=0; i<NS; i++){
-            int psys = i*lN1*N2*N3;
-            fftwnd_mpi(iplan, 1, data_real+psys, work, FFTW_NORMAL_ORDER);
+            int psys = i*total_local_size;
+            fftwnd_mpi(plan, 1, data_fftw+psys, work, order);
           }
         }
 
         /* -----------------------------------------------------------------------
         backward FFT
+        transposed k-space goes through iplan made for ny,nx,nz, whose
+        transposed output is real space in x slabs again
         ---------------------------------------------------------------------*/
-        void FFTW_Slab::backward_mode2()
+        void FFTW_Slab::backward_mode1()
         {
-          int lN1 = local_x;
-          int N2 = local_y;
-          int N3 = local_z;
           int NS = slip_systems;
-          int index = -1, index2 = -1;
-
-          for(int isa=0;isa<NS;isa++){
-            for(int ii=0;ii<total_local_size;ii++){
-              index = isa + ii*NS;
-              index2 = ii + isa*total_local_size;
-              temp_data[index] = data_real[index2];
+          fftwnd_mpi_output_order order =
+            kspace_transposed ? FFTW_TRANSPOSED_ORDER : FFTW_NORMAL_ORDER;
+
+          if (r2c) {
+            for(int i=0; i<NS; i++){
+              int psys = i*total_local_size;
+              rfftwnd_mpi(riplan, 1, (fftw_real *) (data_real+psys),
+                (fftw_real *) work, order);
             }
+            return;
           }
-          fftwnd_mpi(iplan,NS,temp_data,work,FFTW_NORMAL_ORDER);
 
-          for(int isa=0;isa<NS;isa++){
-            for(int ii=0;ii<total_local_size;ii++){
-              index = isa + ii*NS;
-              index2 = ii + isa*total_local_size;
-              data_real[index2] = temp_data[index];
-            }
+          for(int i=0; i<NS; i++){
+            int psys = i*total_local_size;
+            fftwnd_mpi(iplan, 1, data_real+psys, work, order);
           }
         }
 
+#endif
+
         /* -----------------------------------------------------------------------
         Initial Crystal to nothing
         ---------------------------------------------------------------------*/
@@ -1931,6 +2521,8 @@ void FFTW_Slab::fft_send(void *buf, int count, MPI_Datatype datatype, int dest,
           int lxs = local_x_start;
           int N2 = local_y;
           int N3 = local_z;
+          int lys = local_y_start;
+          int lzs = local_z_start;
           obsden = 0.1;
 
           if(me==0){
@@ -1939,17 +2531,15 @@ void FFTW_Slab::fft_send(void *buf, int count, MPI_Datatype datatype, int dest,
           }
           for(is=0;is<NS;is++){
             for(i=0;i<lN1;i++)
-            for(j=0;j<N2;j++)
-            for(k=0;k<N3;k++){
-              na0 = 2*(i*N2*N3+j*N3+k+is*lN1*N2*N3);
-              na = 2*(i*N2*N3+j*N3+k);
-              index = i*N2*N3+j*N3+k+is*lN1*N2*N3;
+            for(j=lys;j<lys+N2;j++)
+            for(k=lzs;k<lzs+N3;k++){
+              na0 = 2*(i*N2*N3+(j-lys)*N3+(k-lzs)+is*lN1*N2*N3);
+              na = 2*(i*N2*N3+(j-lys)*N3+(k-lzs));
+              index = i*N2*N3+(j-lys)*N3+(k-lzs)+is*lN1*N2*N3;
               na1 = na0+1;
               xi[0][na0] = 0.0;      /*(k+1)+(j+1)*10.0+(i+1)*100.0*/
               xi[0][na1] = 0.0;
               xo[index] = 0.0;
-              data_fftw[index].re = xi[0][na0];
-              data_fftw[index].im = xi[0][na1];
             }
           }
           //fclose(of0);
@@ -1981,6 +2571,8 @@ void FFTW_Slab::fft_send(void *buf, int count, MPI_Datatype datatype, int dest,
           int lxs = local_x_start;
           int N2 = local_y;
           int N3 = local_z;
+          int lys = local_y_start;
+          int lzs = local_z_start;
           obsden = 0.1;
 
           if(me==0){
@@ -1989,57 +2581,51 @@ void FFTW_Slab::fft_send(void *buf, int count, MPI_Datatype datatype, int dest,
           }
           for(is=0;is<NS;is++){
             for(i=0;i<lN1;i++)
-              for(j=0;j<N2;j++)
-        	for(k=0;k<N3;k++){
-        	  na0 = 2*(i*N2*N3+j*N3+k+is*lN1*N2*N3);
-        	  na = 2*(i*N2*N3+j*N3+k);
-        	  index = i*N2*N3+j*N3+k+is*lN1*N2*N3;
+              for(j=lys;j<lys+N2;j++)
+        	for(k=lzs;k<lzs+N3;k++){
+        	  na0 = 2*(i*N2*N3+(j-lys)*N3+(k-lzs)+is*lN1*N2*N3);
+        	  na = 2*(i*N2*N3+(j-lys)*N3+(k-lzs));
+        	  index = i*N2*N3+(j-lys)*N3+(k-lzs)+is*lN1*N2*N3;
         	  na1 = na0+1;
         	  xi[0][na0] = 0.0;      /*(k+1)+(j+1)*10.0+(i+1)*100.0*/
         	  xi[0][na1] = 0.0;
         	  xo[index] = 0.0;
-        	  data_fftw[index].re = 0.0;
-        	  data_fftw[index].im = 0.0;
 
 
-        	  if(((k-(local_z/2.0))<eps) &&     // {111} plane
-        	     ((k-(local_z/2.0))>-eps) &&
+        	  if(((k-(nz/2.0))<eps) &&     // {111} plane
+        	     ((k-(nz/2.0))>-eps) &&
         	     (is==0)){
 
-              ar[0] = sclprim[0][0]*((lxs+i)-N1/2.0)+sclprim[0][1]*(j-5.0*local_y/8.0)+sclprim[0][2]*(k-local_z/2.0);
-              ar[1] = sclprim[1][0]*((lxs+i)-N1/2.0)+sclprim[1][1]*(j-5.0*local_y/8.0)+sclprim[1][2]*(k-local_z/2.0);
-              ar[2] = sclprim[2][0]*((lxs+i)-N1/2.0)+sclprim[2][1]*(j-5.0*local_y/8.0)+sclprim[2][2]*(k-local_z/2.0);
+              ar[0] = sclprim[0][0]*((lxs+i)-N1/2.0)+sclprim[0][1]*(j-5.0*ny/8.0)+sclprim[0][2]*(k-nz/2.0);
+              ar[1] = sclprim[1][0]*((lxs+i)-N1/2.0)+sclprim[1][1]*(j-5.0*ny/8.0)+sclprim[1][2]*(k-nz/2.0);
+              ar[2] = sclprim[2][0]*((lxs+i)-N1/2.0)+sclprim[2][1]*(j-5.0*ny/8.0)+sclprim[2][2]*(k-nz/2.0);
 
               ir = sqrt(ar[0]*ar[0]+ar[1]*ar[1]+ar[2]*ar[2]);
-        	    // ir = sqrt(((lxs+i)-N1/2.0)*((lxs+i)-N1/2.0)+(j-3.0*local_y/4.0)*(j-3.0*local_y/4.0)+(k-local_z/2.0)*(k-local_z/2.0));
+        	    // ir = sqrt(((lxs+i)-N1/2.0)*((lxs+i)-N1/2.0)+(j-3.0*ny/4.0)*(j-3.0*ny/4.0)+(k-nz/2.0)*(k-nz/2.0));
 
-        	    if(ir<=(local_y/8.0-2.0)){
+        	    if(ir<=(ny/8.0-2.0)){
         	      xi[0][na0]=1.0;
         	      xi_sum[0][na] = xi_sum[0][na] + xi[0][na0];
         	    }
         	    //write input file
         	    //fprintf(of0, "%d %d %lf %lf %lf\n", lxs+i, j, xi[0][na0], xi[0][na1], xi_sum[0][na]);
-        	    data_fftw[index].re = xi[0][na0];
-        	    data_fftw[index].im = xi[0][na1];
         	  }
-        	  else if(((j-local_y/2.0)<eps) &&                              // {100} plane
-        		  ((j-local_y/2.0)>-eps) &&
+        	  else if(((j-ny/2.0)<eps) &&                              // {100} plane
+        		  ((j-ny/2.0)>-eps) &&
         		  (is==1)){
-                ar[0] = sclprim[0][0]*((lxs+i)-N1/2.0+N1/8.0)+sclprim[0][1]*(j-local_y/2.0)+sclprim[0][2]*(k-5.0*local_z/8.0);
-                ar[1] = sclprim[1][0]*((lxs+i)-N1/2.0+N1/8.0)+sclprim[1][1]*(j-local_y/2.0)+sclprim[1][2]*(k-5.0*local_z/8.0);
-                ar[2] = sclprim[2][0]*((lxs+i)-N1/2.0+N1/8.0)+sclprim[2][1]*(j-local_y/2.0)+sclprim[2][2]*(k-5.0*local_z/8.0);
+                ar[0] = sclprim[0][0]*((lxs+i)-N1/2.0+N1/8.0)+sclprim[0][1]*(j-ny/2.0)+sclprim[0][2]*(k-5.0*nz/8.0);
+                ar[1] = sclprim[1][0]*((lxs+i)-N1/2.0+N1/8.0)+sclprim[1][1]*(j-ny/2.0)+sclprim[1][2]*(k-5.0*nz/8.0);
+                ar[2] = sclprim[2][0]*((lxs+i)-N1/2.0+N1/8.0)+sclprim[2][1]*(j-ny/2.0)+sclprim[2][2]*(k-5.0*nz/8.0);
 
                 ir = sqrt(ar[0]*ar[0]+ar[1]*ar[1]+ar[2]*ar[2]);
 
-        	    // ir = sqrt(((lxs+i)-N1/2.0)*((lxs+i)-N1/2.0)+(j-local_y/2.0)*(j-local_y/2.0)+(k-3.0(k-3.0*local_z/8.0));
-        	    if(ir<=(local_z/8.0-2.0)){
+        	    // ir = sqrt(((lxs+i)-N1/2.0)*((lxs+i)-N1/2.0)+(j-ny/2.0)*(j-ny/2.0)+(k-3.0(k-3.0*nz/8.0));
+        	    if(ir<=(nz/8.0-2.0)){
         	      xi[0][na0]=1.0;
         	      xi_sum[0][na] = xi_sum[0][na] + xi[0][na0];
         	    }
         	    //write input file
         	    //fprintf(of0, "%d %d %lf %lf %lf\n", lxs+i, j, xi[0][na0], xi[0][na1], xi_sum[0][na]);
-        	    data_fftw[index].re = xi[0][na0];
-        	    data_fftw[index].im = xi[0][na1];
         	  }
         	}
           }
@@ -2072,6 +2658,8 @@ void FFTW_Slab::fft_send(void *buf, int count, MPI_Datatype datatype, int dest,
           int lxs = local_x_start;
           int N2 = local_y;
           int N3 = local_z;
+          int lys = local_y_start;
+          int lzs = local_z_start;
           obsden = 0.1;
 
           if(me==0){
@@ -2080,17 +2668,15 @@ void FFTW_Slab::fft_send(void *buf, int count, MPI_Datatype datatype, int dest,
           }
           for(is=0;is<NS;is++){
             for(i=0;i<lN1;i++)
-              for(j=0;j<N2;j++)
-        	for(k=0;k<N3;k++){
-        	  na0 = 2*(i*N2*N3+j*N3+k+is*lN1*N2*N3);
-        	  na = 2*(i*N2*N3+j*N3+k);
-        	  index = i*N2*N3+j*N3+k+is*lN1*N2*N3;
+              for(j=lys;j<lys+N2;j++)
+        	for(k=lzs;k<lzs+N3;k++){
+        	  na0 = 2*(i*N2*N3+(j-lys)*N3+(k-lzs)+is*lN1*N2*N3);
+        	  na = 2*(i*N2*N3+(j-lys)*N3+(k-lzs));
+        	  index = i*N2*N3+(j-lys)*N3+(k-lzs)+is*lN1*N2*N3;
         	  na1 = na0+1;
         	  xi[0][na0] = 0.0;      /*(k+1)+(j+1)*10.0+(i+1)*100.0*/
         	  xi[0][na1] = 0.0;
         	  xo[index] = 0.0;
-        	  data_fftw[index].re = 0.0;
-        	  data_fftw[index].im = 0.0;
 
 
             if (((lxs+i+j+k-N1)<eps) && ((lxs+i+j+k-N1)>-eps) &&
@@ -2102,8 +2688,6 @@ void FFTW_Slab::fft_send(void *buf, int count, MPI_Datatype datatype, int dest,
         	    }
         	    //write input file
         	    //fprintf(of0, "%d %d %lf %lf %lf\n", lxs+i, j, xi[0][na0], xi[0][na1], xi_sum[0][na]);
-        	    data_fftw[index].re = xi[0][na0];
-        	    data_fftw[index].im = xi[0][na1];
         	  }
         	  else if (((lxs+i+j-k)<eps) && ((lxs+i+j-k)>-eps) &&
         	  (is==1)){
@@ -2114,8 +2698,6 @@ void FFTW_Slab::fft_send(void *buf, int count, MPI_Datatype datatype, int dest,
         	    }
         	    //write input file
         	    //fprintf(of0, "%d %d %lf %lf %lf\n", lxs+i, j, xi[0][na0], xi[0][na1], xi_sum[0][na]);
-        	    data_fftw[index].re = xi[0][na0];
-        	    data_fftw[index].im = xi[0][na1];
         	  }
         	}
           }
@@ -2148,6 +2730,8 @@ void FFTW_Slab::fft_send(void *buf, int count, MPI_Datatype datatype, int dest,
           int lxs = local_x_start;
           int N2 = local_y;
           int N3 = local_z;
+          int lys = local_y_start;
+          int lzs = local_z_start;
           obsden = 0.1;
 
           if(me==0){
@@ -2156,22 +2740,20 @@ void FFTW_Slab::fft_send(void *buf, int count, MPI_Datatype datatype, int dest,
           }
           for(is=0;is<NS;is++){
             for(i=0;i<lN1;i++)
-            for(j=0;j<N2;j++)
-            for(k=0;k<N3;k++){
-              na0 = 2*(i*N2*N3+j*N3+k+is*lN1*N2*N3);
-              na = 2*(i*N2*N3+j*N3+k);
-              index = i*N2*N3+j*N3+k+is*lN1*N2*N3;
+            for(j=lys;j<lys+N2;j++)
+            for(k=lzs;k<lzs+N3;k++){
+              na0 = 2*(i*N2*N3+(j-lys)*N3+(k-lzs)+is*lN1*N2*N3);
+              na = 2*(i*N2*N3+(j-lys)*N3+(k-lzs));
+              index = i*N2*N3+(j-lys)*N3+(k-lzs)+is*lN1*N2*N3;
               na1 = na0+1;
               xi[0][na0] = 0.0;      /*(k+1)+(j+1)*10.0+(i+1)*100.0*/
               xi[0][na1] = 0.0;
               xo[index] = 0.0;
-              data_fftw[index].re = 0.0;
-              data_fftw[index].im = 0.0;
 
-              if(((k-(local_z/2.0))<eps) &&                              // {100} plane
-              ((k-(local_z/2.0))>-eps) &&
+              if(((k-(nz/2.0))<eps) &&                              // {100} plane
+              ((k-(nz/2.0))>-eps) &&
               (is==0)){
-                ir = sqrt(((lxs+i)-N1/2.0)*((lxs+i)-N1/2.0)+(j-local_y/2.0)*(j-local_y/2.0));
+                ir = sqrt(((lxs+i)-N1/2.0)*((lxs+i)-N1/2.0)+(j-ny/2.0)*(j-ny/2.0));
 
                 if(ir<=xprd/10.0){
                   xi[0][na0]=1.0;
@@ -2179,8 +2761,6 @@ void FFTW_Slab::fft_send(void *buf, int count, MPI_Datatype datatype, int dest,
                 }
                 //write input file
                 //fprintf(of0, "%d %d %lf %lf %lf\n", lxs+i, j, xi[0][na0], xi[0][na1], xi_sum[0][na]);
-                data_fftw[index].re = xi[0][na0];
-                data_fftw[index].im = xi[0][na1];
               }
             }
           }
@@ -2210,6 +2790,8 @@ void FFTW_Slab::fft_send(void *buf, int count, MPI_Datatype datatype, int dest,
           int lxs = local_x_start;
           int N2 = local_y;
           int N3 = local_z;
+          int lys = local_y_start;
+          int lzs = local_z_start;
           obsden = 0.1;
 
           if(me==0){
@@ -2218,32 +2800,28 @@ void FFTW_Slab::fft_send(void *buf, int count, MPI_Datatype datatype, int dest,
           }
           for(is=0;is<NS;is++){
             for(i=0;i<lN1;i++)
-              for(j=0;j<N2;j++)
-        	for(k=0;k<N3;k++){
-        	  na0 = 2*(i*N2*N3+j*N3+k+is*lN1*N2*N3);
-        	  na = 2*(i*N2*N3+j*N3+k);
-        	  index = i*N2*N3+j*N3+k+is*lN1*N2*N3;
+              for(j=lys;j<lys+N2;j++)
+        	for(k=lzs;k<lzs+N3;k++){
+        	  na0 = 2*(i*N2*N3+(j-lys)*N3+(k-lzs)+is*lN1*N2*N3);
+        	  na = 2*(i*N2*N3+(j-lys)*N3+(k-lzs));
+        	  index = i*N2*N3+(j-lys)*N3+(k-lzs)+is*lN1*N2*N3;
         	  na1 = na0+1;
         	  xi[0][na0] = 0.0;      /*(k+1)+(j+1)*10.0+(i+1)*100.0*/
         	  xi[0][na1] = 0.0;
         	  xo[index] = 0.0;
-        	  data_fftw[index].re = 0.0;
-        	  data_fftw[index].im = 0.0;
 
-            if(((k-(local_z/2.0))<eps) &&
-            ((k-(local_z/2.0))>-eps) &&
+            if(((k-(nz/2.0))<eps) &&
+            ((k-(nz/2.0))>-eps) &&
             (is==0)){
-              ar[0] = sclprim[0][0]*((lxs+i)-N1/2.0)+sclprim[0][1]*(j-local_y/2.0)+sclprim[0][2]*(k-local_z/2.0);
-              ar[1] = sclprim[1][0]*((lxs+i)-N1/2.0)+sclprim[1][1]*(j-local_y/2.0)+sclprim[1][2]*(k-local_z/2.0);
-              ar[2] = sclprim[2][0]*((lxs+i)-N1/2.0)+sclprim[2][1]*(j-local_y/2.0)+sclprim[2][2]*(k-local_z/2.0);
+              ar[0] = sclprim[0][0]*((lxs+i)-N1/2.0)+sclprim[0][1]*(j-ny/2.0)+sclprim[0][2]*(k-nz/2.0);
+              ar[1] = sclprim[1][0]*((lxs+i)-N1/2.0)+sclprim[1][1]*(j-ny/2.0)+sclprim[1][2]*(k-nz/2.0);
+              ar[2] = sclprim[2][0]*((lxs+i)-N1/2.0)+sclprim[2][1]*(j-ny/2.0)+sclprim[2][2]*(k-nz/2.0);
 
               ir = sqrt(ar[0]*ar[0]+ar[1]*ar[1]+ar[2]*ar[2]);
               if(ir <= 10.0){
                 xi[0][na0]=1.0;
                 xi_sum[0][na] = xi_sum[0][na] + xi[0][na0];
               }
-              data_fftw[index].re = xi[0][na0];
-              data_fftw[index].im = xi[0][na1];
             }
         	} // i, j, k
         } // is
@@ -2275,6 +2853,8 @@ void FFTW_Slab::fft_send(void *buf, int count, MPI_Datatype datatype, int dest,
           int lxs = local_x_start;
           int N2 = local_y;
           int N3 = local_z;
+          int lys = local_y_start;
+          int lzs = local_z_start;
           obsden = 0.1;
 
           if(me==0){
@@ -2283,27 +2863,23 @@ void FFTW_Slab::fft_send(void *buf, int count, MPI_Datatype datatype, int dest,
           }
           for(is=0;is<NS;is++){
             for(i=0;i<lN1;i++)
-              for(j=0;j<N2;j++)
-        	for(k=0;k<N3;k++){
-        	  na0 = 2*(i*N2*N3+j*N3+k+is*lN1*N2*N3);
-        	  na = 2*(i*N2*N3+j*N3+k);
-        	  index = i*N2*N3+j*N3+k+is*lN1*N2*N3;
+              for(j=lys;j<lys+N2;j++)
+        	for(k=lzs;k<lzs+N3;k++){
+        	  na0 = 2*(i*N2*N3+(j-lys)*N3+(k-lzs)+is*lN1*N2*N3);
+        	  na = 2*(i*N2*N3+(j-lys)*N3+(k-lzs));
+        	  index = i*N2*N3+(j-lys)*N3+(k-lzs)+is*lN1*N2*N3;
         	  na1 = na0+1;
         	  xi[0][na0] = 0.0;      /*(k+1)+(j+1)*10.0+(i+1)*100.0*/
         	  xi[0][na1] = 0.0;
         	  xo[index] = 0.0;
-        	  data_fftw[index].re = 0.0;
-        	  data_fftw[index].im = 0.0;
 
             if (((lxs+i+j+k-N1)<eps) && ((lxs+i+j+k-N1)>-eps) &&
             (is==0)){
-              ir = app->sa*sqrt(((lxs+i)-N1/3.0)*((lxs+i)-N1/3.0)+(j-local_y/3.0)*(j-local_y/3.0)+(k-local_z/3.0)*(k-local_z/3.0));
+              ir = app->sa*sqrt(((lxs+i)-N1/3.0)*((lxs+i)-N1/3.0)+(j-ny/3.0)*(j-ny/3.0)+(k-nz/3.0)*(k-nz/3.0));
               if(ir <= 5.0*sqrt(2.0)){
         	      xi[0][na0]=1.0;
         	      xi_sum[0][na] = xi_sum[0][na] + xi[0][na0];
         	    }
-        	    data_fftw[index].re = xi[0][na0];
-        	    data_fftw[index].im = xi[0][na1];
             }
         	} //i,j,k
         } //NS
@@ -2335,6 +2911,8 @@ void FFTW_Slab::fft_send(void *buf, int count, MPI_Datatype datatype, int dest,
           int lxs = local_x_start;
           int N2 = local_y;
           int N3 = local_z;
+          int lys = local_y_start;
+          int lzs = local_z_start;
           obsden = 0.1;
 
           if(me==0){
@@ -2343,22 +2921,20 @@ void FFTW_Slab::fft_send(void *buf, int count, MPI_Datatype datatype, int dest,
           }
           for(is=0;is<NS;is++){
             for(i=0;i<lN1;i++)
-            for(j=0;j<N2;j++)
-            for(k=0;k<N3;k++){
-              na0 = 2*(i*N2*N3+j*N3+k+is*lN1*N2*N3);
-              na = 2*(i*N2*N3+j*N3+k);
-              index = i*N2*N3+j*N3+k+is*lN1*N2*N3;
+            for(j=lys;j<lys+N2;j++)
+            for(k=lzs;k<lzs+N3;k++){
+              na0 = 2*(i*N2*N3+(j-lys)*N3+(k-lzs)+is*lN1*N2*N3);
+              na = 2*(i*N2*N3+(j-lys)*N3+(k-lzs));
+              index = i*N2*N3+(j-lys)*N3+(k-lzs)+is*lN1*N2*N3;
               na1 = na0+1;
               xi[0][na0] = 0.0;      /*(k+1)+(j+1)*10.0+(i+1)*100.0*/
               xi[0][na1] = 0.0;
               xo[index] = 0.0;
-              data_fftw[index].re = 0.0;
-              data_fftw[index].im = 0.0;
 
-              if(((k-(local_z/2.0))<eps) &&                              // {100} plane
-              ((k-(local_z/2.0))>-eps) &&
+              if(((k-(nz/2.0))<eps) &&                              // {100} plane
+              ((k-(nz/2.0))>-eps) &&
               (is==0)){
-                ir = sqrt(app->sa*((lxs+i)-N1/2.0)*app->sa*((lxs+i)-N1/2.0)+app->sb*(j-local_y/2.0)*app->sb*(j-local_y/2.0));
+                ir = sqrt(app->sa*((lxs+i)-N1/2.0)*app->sa*((lxs+i)-N1/2.0)+app->sb*(j-ny/2.0)*app->sb*(j-ny/2.0));
 
                 //if(ir<=xprd/6.0){
                 if(ir <= 10*app->sa){
@@ -2367,8 +2943,6 @@ void FFTW_Slab::fft_send(void *buf, int count, MPI_Datatype datatype, int dest,
                 }
                 //write input file
                 //fprintf(of0, "%d %d %lf %lf %lf\n", lxs+i, j, xi[0][na0], xi[0][na1], xi_sum[0][na]);
-                data_fftw[index].re = xi[0][na0];
-                data_fftw[index].im = xi[0][na1];
               }
             }
           }
@@ -2400,6 +2974,8 @@ void FFTW_Slab::fft_send(void *buf, int count, MPI_Datatype datatype, int dest,
           int lxs = local_x_start;
           int N2 = local_y;
           int N3 = local_z;
+          int lys = local_y_start;
+          int lzs = local_z_start;
           obsden = 0.1;
 
           if(me==0){
@@ -2408,11 +2984,11 @@ void FFTW_Slab::fft_send(void *buf, int count, MPI_Datatype datatype, int dest,
           }
           for(is=0;is<NS;is++){
             for(i=0;i<lN1;i++)
-            for(j=0;j<N2;j++)
-            for(k=0;k<N3;k++){
-              na0 = 2*(i*N2*N3+j*N3+k+is*lN1*N2*N3);
-              na = 2*(i*N2*N3+j*N3+k);
-              index = i*N2*N3+j*N3+k+is*lN1*N2*N3;
+            for(j=lys;j<lys+N2;j++)
+            for(k=lzs;k<lzs+N3;k++){
+              na0 = 2*(i*N2*N3+(j-lys)*N3+(k-lzs)+is*lN1*N2*N3);
+              na = 2*(i*N2*N3+(j-lys)*N3+(k-lzs));
+              index = i*N2*N3+(j-lys)*N3+(k-lzs)+is*lN1*N2*N3;
               na1 = na0+1;
               xi[0][na0] = 0.0;      /*(k+1)+(j+1)*10.0+(i+1)*100.0*/
               xi[0][na1] = 0.0;
@@ -2423,23 +2999,21 @@ void FFTW_Slab::fft_send(void *buf, int count, MPI_Datatype datatype, int dest,
               // yf = ((lxs+i)*four[1][0] + j*four[1][1] + k*four[1][2])/normfour[1];
               // zf = ((lxs+i)*four[2][0] + j*four[2][1] + k*four[2][2])/normfour[2];
 
-              if((2.8284*(j-local_y/2.0)+(k-local_z/2.0)<20.0*eps) &&     // {111} plane
-              (2.8284*(j-local_y/2.0)+(k-local_z/2.0)>-20.0*eps) &&
+              if((2.8284*(j-ny/2.0)+(k-nz/2.0)<20.0*eps) &&     // {111} plane
+              (2.8284*(j-ny/2.0)+(k-nz/2.0)>-20.0*eps) &&
               (is==1)){
-                ir = sqrt(((lxs+i)-N1/2.0)*((lxs+i)-N1/2.0)+(j-local_y/2.0)*(j-local_y/2.0)+(k-local_z/2.0)*(k-local_z/2.0));
+                ir = sqrt(((lxs+i)-N1/2.0)*((lxs+i)-N1/2.0)+(j-ny/2.0)*(j-ny/2.0)+(k-nz/2.0)*(k-nz/2.0));
                 if(ir<=xprd/20.0){
                   xi[0][na0]=1.0;
                   xi_sum[0][na] = xi_sum[0][na] + xi[0][na0];
                 }
                 //write input file
                 //fprintf(of0, "%d %d %lf %lf %lf\n", lxs+i, j, xi[0][na0], xi[0][na1], xi_sum[0][na]);
-                data_fftw[index].re = xi[0][na0];
-                data_fftw[index].im = xi[0][na1];
               }
-              else if(((k-(local_z/4.0))<eps) &&                              // {100} plane
-              ((k-(local_z/4.0))>-eps) &&
+              else if(((k-(nz/4.0))<eps) &&                              // {100} plane
+              ((k-(nz/4.0))>-eps) &&
               (is==0)){
-                ir = sqrt(((lxs+i)-N1/2.0)*((lxs+i)-N1/2.0)+(j-local_y/2.0)*(j-local_y/2.0)+(k-local_z/4.0)*(k-local_z/4.0));
+                ir = sqrt(((lxs+i)-N1/2.0)*((lxs+i)-N1/2.0)+(j-ny/2.0)*(j-ny/2.0)+(k-nz/4.0)*(k-nz/4.0));
 
                 if(ir<=xprd/20.0){
                   xi[0][na0]=1.0;
@@ -2447,8 +3021,6 @@ void FFTW_Slab::fft_send(void *buf, int count, MPI_Datatype datatype, int dest,
                 }
                 //write input file
                 //fprintf(of0, "%d %d %lf %lf %lf\n", lxs+i, j, xi[0][na0], xi[0][na1], xi_sum[0][na]);
-                data_fftw[index].re = xi[0][na0];
-                data_fftw[index].im = xi[0][na1];
               }
             }
           }
@@ -2478,6 +3050,8 @@ void FFTW_Slab::fft_send(void *buf, int count, MPI_Datatype datatype, int dest,
           int lxs = local_x_start;
           int N2 = local_y;
           int N3 = local_z;
+          int lys = local_y_start;
+          int lzs = local_z_start;
           obsden = 0.1;
 
           if(me==0){
@@ -2486,19 +3060,19 @@ void FFTW_Slab::fft_send(void *buf, int count, MPI_Datatype datatype, int dest,
           }
           for(is=0;is<NS;is++){
             for(i=0;i<lN1;i++)
-              for(j=0;j<N2;j++)
-        	for(k=0;k<N3;k++){
-        	  na0 = 2*(i*N2*N3+j*N3+k+is*lN1*N2*N3);
-        	  na = 2*(i*N2*N3+j*N3+k);
-        	  index = i*N2*N3+j*N3+k+is*lN1*N2*N3;
+              for(j=lys;j<lys+N2;j++)
+        	for(k=lzs;k<lzs+N3;k++){
+        	  na0 = 2*(i*N2*N3+(j-lys)*N3+(k-lzs)+is*lN1*N2*N3);
+        	  na = 2*(i*N2*N3+(j-lys)*N3+(k-lzs));
+        	  index = i*N2*N3+(j-lys)*N3+(k-lzs)+is*lN1*N2*N3;
         	  na1 = na0+1;
         	  xi[0][na0] = 0.0;      /*(k+1)+(j+1)*10.0+(i+1)*100.0*/
         	  xi[0][na1] = 0.0;
         	  xo[index] = 0.0;
 
-            if(((k-local_z/2.0)<eps) &&     // {001} plane
-              ((k-local_z/2.0)>-eps) &&
-              (j>(N2/4.0)) && (j<(3.0*N2/4.0)) && //((lxs+i)>(N1/4.0)) && ((lxs+i)<(3.0*N1/4.0)) && //
+            if(((k-nz/2.0)<eps) &&     // {001} plane
+              ((k-nz/2.0)>-eps) &&
+              (j>(ny/4.0)) && (j<(3.0*ny/4.0)) && //((lxs+i)>(N1/4.0)) && ((lxs+i)<(3.0*N1/4.0)) && //
               (is==0)){
 
 
@@ -2507,8 +3081,6 @@ void FFTW_Slab::fft_send(void *buf, int count, MPI_Datatype datatype, int dest,
 
               //write input file
               //fprintf(of0, "%d %d %lf %lf %lf\n", lxs+i, j, xi[0][na0], xi[0][na1], xi_sum[0][na]);
-              data_fftw[index].re = xi[0][na0];
-              data_fftw[index].im = xi[0][na1];
             }
         	}
           }
@@ -2539,6 +3111,8 @@ void FFTW_Slab::fft_send(void *buf, int count, MPI_Datatype datatype, int dest,
           int lxs = local_x_start;
           int N2 = local_y;
           int N3 = local_z;
+          int lys = local_y_start;
+          int lzs = local_z_start;
           obsden = 0.1;
 
           if(me==0){
@@ -2547,27 +3121,25 @@ void FFTW_Slab::fft_send(void *buf, int count, MPI_Datatype datatype, int dest,
           }
           for(is=0;is<NS;is++){
             for(i=0;i<lN1;i++)
-              for(j=0;j<N2;j++)
-        	for(k=0;k<N3;k++){
-        	  na0 = 2*(i*N2*N3+j*N3+k+is*lN1*N2*N3);
-        	  na = 2*(i*N2*N3+j*N3+k);
-        	  index = i*N2*N3+j*N3+k+is*lN1*N2*N3;
+              for(j=lys;j<lys+N2;j++)
+        	for(k=lzs;k<lzs+N3;k++){
+        	  na0 = 2*(i*N2*N3+(j-lys)*N3+(k-lzs)+is*lN1*N2*N3);
+        	  na = 2*(i*N2*N3+(j-lys)*N3+(k-lzs));
+        	  index = i*N2*N3+(j-lys)*N3+(k-lzs)+is*lN1*N2*N3;
         	  na1 = na0+1;
         	  xi[0][na0] = 0.0;      /*(k+1)+(j+1)*10.0+(i+1)*100.0*/
         	  xi[0][na1] = 0.0;
         	  xo[index] = 0.0;
 
 
-        	  if(((k-local_z/2.0)<eps) &&     // {111} plane
-        	     ((k-local_z/2.0)>-eps) &&
+        	  if(((k-nz/2.0)<eps) &&     // {111} plane
+        	     ((k-nz/2.0)>-eps) &&
         	     (((2*(lxs+i)-j)<=(-N1)) || (((2*(lxs+i)-j)>=0.0) && ((2*(lxs+i)-j)<=(N1)))) &&
         	     (is==0)){
 
         	    xi[0][na0]=1.0;
         	    xi_sum[0][na] = xi_sum[0][na] + xi[0][na0];
 
-        	    data_fftw[index].re = xi[0][na0];
-        	    data_fftw[index].im = xi[0][na1];
         	  }
         	}
           }
@@ -2599,6 +3171,8 @@ void FFTW_Slab::fft_send(void *buf, int count, MPI_Datatype datatype, int dest,
           int lxs = local_x_start;
           int N2 = local_y;
           int N3 = local_z;
+          int lys = local_y_start;
+          int lzs = local_z_start;
           obsden = 0.1;
 
           if(me==0){
@@ -2607,11 +3181,11 @@ void FFTW_Slab::fft_send(void *buf, int count, MPI_Datatype datatype, int dest,
           }
           for(is=0;is<NS;is++){
             for(i=0;i<lN1;i++)
-            for(j=0;j<N2;j++)
-            for(k=0;k<N3;k++){
-              na0 = 2*(i*N2*N3+j*N3+k+is*lN1*N2*N3);
-              na = 2*(i*N2*N3+j*N3+k);
-              index = i*N2*N3+j*N3+k+is*lN1*N2*N3;
+            for(j=lys;j<lys+N2;j++)
+            for(k=lzs;k<lzs+N3;k++){
+              na0 = 2*(i*N2*N3+(j-lys)*N3+(k-lzs)+is*lN1*N2*N3);
+              na = 2*(i*N2*N3+(j-lys)*N3+(k-lzs));
+              index = i*N2*N3+(j-lys)*N3+(k-lzs)+is*lN1*N2*N3;
               na1 = na0+1;
               xi[0][na0] = 0.0;      /*(k+1)+(j+1)*10.0+(i+1)*100.0*/
               xi[0][na1] = 0.0;
@@ -2626,9 +3200,9 @@ void FFTW_Slab::fft_send(void *buf, int count, MPI_Datatype datatype, int dest,
               // yf = ((lxs+i)*prim[1][0] + j*prim[1][1] + k*prim[1][2]);
               // zf = ((lxs+i)*prim[2][0] + j*prim[2][1] + k*prim[2][2]);
 
-              if(((k-local_z/2.0)<eps) &&     // {001} plane
-              ((k-local_z/2.0)>-eps) &&
-              ((lxs+i)>(N1/4.0)) && ((lxs+i)<(3.0*N1/4.0)) && //(j>(N2/4.0)) && (j<(3.0*N2/4.0))
+              if(((k-nz/2.0)<eps) &&     // {001} plane
+              ((k-nz/2.0)>-eps) &&
+              ((lxs+i)>(N1/4.0)) && ((lxs+i)<(3.0*N1/4.0)) && //(j>(ny/4.0)) && (j<(3.0*ny/4.0))
               (is==0)){
                 // if(((zf-cntf[2])<eps) &&     // {111} plane
                 //    ((zf-cntf[2])>-eps) &&
@@ -2642,8 +3216,6 @@ void FFTW_Slab::fft_send(void *buf, int count, MPI_Datatype datatype, int dest,
 
                 //write input file
                 //fprintf(of0, "%d %d %lf %lf %lf\n", lxs+i, j, xi[0][na0], xi[0][na1], xi_sum[0][na]);
-                data_fftw[index].re = xi[0][na0];
-                data_fftw[index].im = xi[0][na1];
               }
               // else if(((zf-(cntf[2]/2.0))<eps) &&                              // {100} plane
               // 	  ((zf-(cntf[2]/2.0))>-eps) &&
@@ -2684,6 +3256,8 @@ void FFTW_Slab::fft_send(void *buf, int count, MPI_Datatype datatype, int dest,
           int lxs = local_x_start;
           int N2 = local_y;
           int N3 = local_z;
+          int lys = local_y_start;
+          int lzs = local_z_start;
           obsden = 0.1;
 
           if(me==0){
@@ -2692,11 +3266,11 @@ void FFTW_Slab::fft_send(void *buf, int count, MPI_Datatype datatype, int dest,
           }
           for(is=0;is<NS;is++){
             for(i=0;i<lN1;i++)
-            for(j=0;j<N2;j++)
-            for(k=0;k<N3;k++){
-              na0 = 2*(i*N2*N3+j*N3+k+is*lN1*N2*N3);
-              na = 2*(i*N2*N3+j*N3+k);
-              index = i*N2*N3+j*N3+k+is*lN1*N2*N3;
+            for(j=lys;j<lys+N2;j++)
+            for(k=lzs;k<lzs+N3;k++){
+              na0 = 2*(i*N2*N3+(j-lys)*N3+(k-lzs)+is*lN1*N2*N3);
+              na = 2*(i*N2*N3+(j-lys)*N3+(k-lzs));
+              index = i*N2*N3+(j-lys)*N3+(k-lzs)+is*lN1*N2*N3;
               na1 = na0+1;
               xi[0][na0] = 0.0;      /*(k+1)+(j+1)*10.0+(i+1)*100.0*/
               xi[0][na1] = 0.0;
@@ -2709,9 +3283,9 @@ void FFTW_Slab::fft_send(void *buf, int count, MPI_Datatype datatype, int dest,
                 //      }
                 xo[index] = 1.0;
               }
-              if(((k-local_z/2.0)<eps) && ((k-local_z/2.0)>-eps)){    // {0001} plane
-              //    if(k == (N3/2.0)){
-              //      ir = (((lxs+i)-(N1-1))*((lxs+i)-(N1-1)))+((j-N2/2)*(j-N2/2));
+              if(((k-nz/2.0)<eps) && ((k-nz/2.0)>-eps)){    // {0001} plane
+              //    if(k == (nz/2.0)){
+              //      ir = (((lxs+i)-(N1-1))*((lxs+i)-(N1-1)))+((j-ny/2)*(j-ny/2));
               //      //if(ir<=N1/2){
               //      if(ir<=25){
               //        if((lxs+i)== (N1-1) || (lxs+i)== (N1-2)){
@@ -2722,7 +3296,7 @@ void FFTW_Slab::fft_send(void *buf, int count, MPI_Datatype datatype, int dest,
               //        }
               //      }
               //ledge or notch
-              ir = (((lxs+i)-5.0)*((lxs+i)-5.0))+((j-N2/2)*(j-N2/2));
+              ir = (((lxs+i)-5.0)*((lxs+i)-5.0))+((j-ny/2)*(j-ny/2));
               if(ir<=25){
                 //if((lxs+i)>=5){
                 if((lxs+i) == 5 || (lxs+i) == 6){
@@ -2736,8 +3310,6 @@ void FFTW_Slab::fft_send(void *buf, int count, MPI_Datatype datatype, int dest,
               //      xi[0][na0] = 1.0;
               //      xi_sum[0][na] = xi_sum[0][na] + xi[0][na0];
 
-              data_fftw[index].re = xi[0][na0];
-              data_fftw[index].im = xi[0][na1];
             }
           } //ijk
         } //is
@@ -2766,6 +3338,8 @@ void FFTW_Slab::fft_send(void *buf, int count, MPI_Datatype datatype, int dest,
         int lxs = local_x_start;
         int N2 = local_y;
         int N3 = local_z;
+        int lys = local_y_start;
+        int lzs = local_z_start;
         obsden = 0.1;
 
         int fr_halflen = 10;
@@ -2776,35 +3350,31 @@ void FFTW_Slab::fft_send(void *buf, int count, MPI_Datatype datatype, int dest,
         }
         for(is=0;is<NS;is++)
         for(i=0;i<lN1;i++)
-        for(j=0;j<N2;j++)
-        for(k=0;k<N3;k++){
-          na0 = 2*(i*N2*N3+j*N3+k+is*lN1*N2*N3);
-          na = 2*(i*N2*N3+j*N3+k);
-          index = i*N2*N3+j*N3+k+is*lN1*N2*N3;
+        for(j=lys;j<lys+N2;j++)
+        for(k=lzs;k<lzs+N3;k++){
+          na0 = 2*(i*N2*N3+(j-lys)*N3+(k-lzs)+is*lN1*N2*N3);
+          na = 2*(i*N2*N3+(j-lys)*N3+(k-lzs));
+          index = i*N2*N3+(j-lys)*N3+(k-lzs)+is*lN1*N2*N3;
           na1 = na0+1;
           xi[0][na0] = 0.0;
           xi[0][na1] = 0.0;
           xo[index] = 0.0;
-          data_fftw[index].re = 0.0;
-          data_fftw[index].im = 0.0;
 
-          /*if(is == 1 && (lxs+i) == N1/2 && k <= N3/2 && j < N2/2 + fr_halflen && j >= N2/2 - fr_halflen){
+          /*if(is == 1 && (lxs+i) == N1/2 && k <= nz/2 && j < ny/2 + fr_halflen && j >= ny/2 - fr_halflen){
           xi[0][na0]=1.0;
           xi_sum[0][na] = xi_sum[0][na] + xi[0][na0];
         }
-        if(k != N3/2){ //confine slip to mid z plane
+        if(k != nz/2){ //confine slip to mid z plane
         xo[index] = 1.0;
       }*/
-      if(is == 1 && (lxs+i) < N1/2 + fr_halflen && (lxs+i) >= N1/2 - fr_halflen && j <= N2/2 && k == N3/2){
+      if(is == 1 && (lxs+i) < N1/2 + fr_halflen && (lxs+i) >= N1/2 - fr_halflen && j <= ny/2 && k == nz/2){
         xi[0][na0] = 1.0;
         xi_sum[0][na] = xi_sum[0][na] + xi[0][na0];
       }
-      if(j != 0 && j != N2/2){
+      if(j != 0 && j != ny/2){
         xo[index] = 1.0;
       }
 
-      data_fftw[index].re = xi[0][na0];
-      data_fftw[index].im = xi[0][na1];
     }
     if(me==0){
       if (logfile) fprintf(logfile,"Initial configuration of order parameters COMPLETE ...\n");
@@ -2829,6 +3399,8 @@ void FFTW_Slab::fft_send(void *buf, int count, MPI_Datatype datatype, int dest,
     int lxs = local_x_start;
     int N2 = local_y;
     int N3 = local_z;
+    int lys = local_y_start;
+    int lzs = local_z_start;
     obsden = 0.1;
 
     if(me==0){
@@ -2837,25 +3409,21 @@ void FFTW_Slab::fft_send(void *buf, int count, MPI_Datatype datatype, int dest,
     }
     for(is=0;is<NS;is++)
     for(i=0;i<lN1;i++)
-    for(j=0;j<N2;j++)
-    for(k=0;k<N3;k++){
-      na0 = 2*(i*N2*N3+j*N3+k+is*lN1*N2*N3);
-      na = 2*(i*N2*N3+j*N3+k);
-      index = i*N2*N3+j*N3+k+is*lN1*N2*N3;
+    for(j=lys;j<lys+N2;j++)
+    for(k=lzs;k<lzs+N3;k++){
+      na0 = 2*(i*N2*N3+(j-lys)*N3+(k-lzs)+is*lN1*N2*N3);
+      na = 2*(i*N2*N3+(j-lys)*N3+(k-lzs));
+      index = i*N2*N3+(j-lys)*N3+(k-lzs)+is*lN1*N2*N3;
       na1 = na0+1;
       xi[0][na0] = 0.0;
       xi[0][na1] = 0.0;
       xo[index] = 0.0;
-      data_fftw[index].re = 0.0;
-      data_fftw[index].im = 0.0;
 
-      if(is == 0 && (lxs+i) == 0 && k >= N3/4 && k < N3*3/4){
+      if(is == 0 && (lxs+i) == 0 && k >= nz/4 && k < nz*3/4){
         xi[0][na0] = 1.0;
         xi_sum[0][na] = xi_sum[0][na] + xi[0][na0];
       }
 
-      data_fftw[index].re = xi[0][na0];
-      data_fftw[index].im = xi[0][na1];
     }
     if(me==0){
       if (logfile) fprintf(logfile,"Initial configuration of order parameters COMPLETE ...\n");
@@ -2880,6 +3448,8 @@ void FFTW_Slab::fft_send(void *buf, int count, MPI_Datatype datatype, int dest,
     int lxs = local_x_start;
     int N2 = local_y;
     int N3 = local_z;
+    int lys = local_y_start;
+    int lzs = local_z_start;
     int dist[3];
     obsden = 0.1;
 
@@ -2889,28 +3459,24 @@ void FFTW_Slab::fft_send(void *buf, int count, MPI_Datatype datatype, int dest,
     }
     for(is=0;is<NS;is++)
     for(i=0;i<lN1;i++)
-    for(j=0;j<N2;j++)
-    for(k=0;k<N3;k++){
-      na0 = 2*(i*N2*N3+j*N3+k+is*lN1*N2*N3);
-      na = 2*(i*N2*N3+j*N3+k);
-      index = i*N2*N3+j*N3+k+is*lN1*N2*N3;
+    for(j=lys;j<lys+N2;j++)
+    for(k=lzs;k<lzs+N3;k++){
+      na0 = 2*(i*N2*N3+(j-lys)*N3+(k-lzs)+is*lN1*N2*N3);
+      na = 2*(i*N2*N3+(j-lys)*N3+(k-lzs));
+      index = i*N2*N3+(j-lys)*N3+(k-lzs)+is*lN1*N2*N3;
       na1 = na0+1;
       xi[0][na0] = 0.0;
       xi[0][na1] = 0.0;
       xo[index] = 0.0;
-      data_fftw[index].re = 0.0;
-      data_fftw[index].im = 0.0;
-      dist[0] = -1*(j-N2/2)+(k-N3/2);
-      dist[1] = (j-N2/2)-(k-N3/2);
-      dist[2] = (j-N2/2)+(k-N3/2);
+      dist[0] = -1*(j-ny/2)+(k-nz/2);
+      dist[1] = (j-ny/2)-(k-nz/2);
+      dist[2] = (j-ny/2)+(k-nz/2);
 
       if(is == 0 && (lxs+i) == 0 && dist[0]*dist[0]+dist[1]*dist[1]+dist[2]*dist[2] < 3*16*16){
         xi[0][na0] = 1.0;
         xi_sum[0][na] = xi_sum[0][na] + xi[0][na0];
       }
 
-      data_fftw[index].re = xi[0][na0];
-      data_fftw[index].im = xi[0][na1];
     }
     if(me==0){
       if (logfile) fprintf(logfile,"Initial configuration of order parameters COMPLETE ...\n");
@@ -2935,6 +3501,8 @@ void FFTW_Slab::fft_send(void *buf, int count, MPI_Datatype datatype, int dest,
     int lxs = local_x_start;
     int N2 = local_y;
     int N3 = local_z;
+    int lys = local_y_start;
+    int lzs = local_z_start;
     obsden = 0.1;
 
     if(me==0){
@@ -2943,17 +3511,17 @@ void FFTW_Slab::fft_send(void *buf, int count, MPI_Datatype datatype, int dest,
     }
     for(is=0;is<NS;is++)
     for(i=0;i<lN1;i++)
-    for(j=0;j<N2;j++)
-    for(k=0;k<N3;k++){
-      na0 = 2*(i*N2*N3+j*N3+k+is*lN1*N2*N3);
-      na = 2*(i*N2*N3+j*N3+k);
-      index = i*N2*N3+j*N3+k+is*lN1*N2*N3;
+    for(j=lys;j<lys+N2;j++)
+    for(k=lzs;k<lzs+N3;k++){
+      na0 = 2*(i*N2*N3+(j-lys)*N3+(k-lzs)+is*lN1*N2*N3);
+      na = 2*(i*N2*N3+(j-lys)*N3+(k-lzs));
+      index = i*N2*N3+(j-lys)*N3+(k-lzs)+is*lN1*N2*N3;
       na1 = na0+1;
       xi[0][na0] = 0.0;
       xi[0][na1] = 0.0;
       xo[index] = 0.0;
       //N3 must be 3*N2 for this to make an edge dislocation !!!
-      if(is == 0 && (lxs+i) == 0 && ((k <= 3*j && (k+N3/2 > 3*j)) || (k - N3/2) > 3*j)){
+      if(is == 0 && (lxs+i) == 0 && ((k <= 3*j && (k+nz/2 > 3*j)) || (k - nz/2) > 3*j)){
         xi[0][na0] = 1.0;
         xi_sum[0][na] = xi_sum[0][na] + xi[0][na0];
       }
@@ -2979,7 +3547,7 @@ void FFTW_Slab::fft_send(void *buf, int count, MPI_Datatype datatype, int dest,
     int N3 = local_z;
     int NP = num_planes;
     int NS = slip_systems;
-    int nsize = N1*N2*N3;
+    int nsize = N1*ny*nz;
     int i, j, k, l, is, nb, ida, idb;
     double S[ND][ND][ND][ND];
     double S44 = material->S44;
@@ -3058,7 +3626,7 @@ void FFTW_Slab::total_average_strain()
   int N3 = local_z;
   int NP = num_planes;
   int NS = slip_systems;
-  int nsize = N1*N2*N3;
+  int nsize = N1*ny*nz;
   int i, j, k, l, is, nb, ida, idb, na0;
 
   for(ida=0;ida<ND;ida++){
@@ -3097,18 +3665,21 @@ void FFTW_Slab::strain()
   int N3 = local_z;
   int NP = num_planes;
   int NS = slip_systems;
-  int nsize = N1*N2*N3;
-  int i, j, k, l, is, na0, na1, nb, psys, ida, idb, index, index2;
+  int nsize = N1*ny*nz;
+  int i, j, k, l, q, is, na0, na1, nb, ida, idb, index, index2;
   int na11, na12, na13, na21, na22, na23, na31, na32, na33, ia, ib;
-  fftwnd_mpi_plan iiplan;
 
-  iiplan = fftw3d_mpi_create_plan(world, N1, N2, N3, FFTW_BACKWARD, FFTW_ESTIMATE);
+  int kN1 = local_kn1;
+  int kN2 = local_kn2;
+  int NK = local_kz;
+  int SK = strain_stride;
+  int DS = total_local_size;
 
-  for (i=0; i<lN1*N2*N3*ND*ND; i++){
+  for (i=0; i<SK*ND*ND; i++){
     data_strain[i].re = 0.0;
     data_strain[i].im = 0.0;
   }
-  for (i=0; i<lN1*N2*N3; i++){
+  for (i=0; i<total_local_size; i++){
     work_strain[i].re = 0.0;
     work_strain[i].im = 0.0;
   }
@@ -3118,31 +3689,62 @@ void FFTW_Slab::strain()
 
   /*calculate the total strain */
 
-  for(is=0;is<NS;is++){
-    for (ida=0; ida<ND; ida++){
-      for (idb=0; idb<ND; idb++){
-        for(i=0;i<lN1;i++){
-          for(j=0;j<N2;j++){
-            for(k=0;k<N3;k++){
-              index = i*N2*N3 + j*N3 + k + is*lN1*N2*N3;
-              index2 = i*N2*N3 + j*N3 + k + ida*lN1*N2*N3 + idb*lN1*N2*N3*ND;
-              nb = k + j*N3 + i*N2*N3 + is*lN1*N2*N3 + ida*lN1*N2*N3*NS + idb*lN1*N2*N3*NS*ND;
-              data_strain[index2].re += data_fftw[index].re * FF[nb];
-              data_strain[index2].im += data_fftw[index].im * FF[nb];
-
-            }
-          }
+  // F of k-point q is at fq + (is + ida*NS + idb*NS*ND)*fs, made here
+  // for each k-point with matrix_free
+  int L = kN1*kN2*NK;
+  const double *fq;
+  int fs;
+
+  for(q=0;q<L;q++){
+    if (matrix_free) {
+      ff_point(q,ffk,1);
+      fq = ffk;
+      fs = 1;
+    }
+    else {
+      fq = FF + q;
+      fs = L;
+    }
+    for(is=0;is<NS;is++){
+      for (ida=0; ida<ND; ida++){
+        for (idb=0; idb<ND; idb++){
+          index = q + is*DS;
+          index2 = q + ida*SK + idb*SK*ND;
+          nb = (is + ida*NS + idb*NS*ND)*fs;
+          data_strain[index2].re += data_fftw[index].re * fq[nb];
+          data_strain[index2].im += data_fftw[index].im * fq[nb];
         }
       }
     }
   }
 
-  for(i=0;i<ND;i++){
-    for (j=0;j<ND;j++){
-      psys = i*lN1*N2*N3 + j*lN1*N2*N3*ND;
-      fftwnd_mpi(iiplan, 1, data_strain+psys, work_strain, FFTW_NORMAL_ORDER); /* Inverse FFT (multiple)*/
+  backward_strain();
+
+  // c2r leaves padded real rows in each component slot, unpack them
+  // in order through work_strain so no component is overwritten early,
+  // c2c components only move down when the slots are larger
+  if (r2c) {
+    double *rwork = (double *) work_strain;
+    for (l=0; l<ND*ND; l++){
+      double *rdata = (double *) (data_strain + l*SK);
+      for (i=0; i<2*lN1*N2*NK; i++) rwork[i] = rdata[i];
+      for(i=0;i<lN1;i++){
+        for(j=0;j<N2;j++){
+          for(k=0;k<N3;k++){
+            index = k + j*N3 + i*N2*N3 + l*lN1*N2*N3;
+            data_strain[index].re = rwork[i*N2*2*NK + j*2*NK + k];
+            data_strain[index].im = 0.0;
+          }
+        }
+      }
     }
   }
+  else if (SK != lN1*N2*N3) {
+    for (l=1; l<ND*ND; l++)
+      memmove(data_strain + l*lN1*N2*N3, data_strain + l*SK,
+              lN1*N2*N3*sizeof(FFT_DATA));
+  }
+
   for (i=0; i<lN1*N2*N3*ND*ND; i++){
     data_strain[i].re = data_strain[i].re/(nsize);
     data_strain[i].im = data_strain[i].im/(nsize);
@@ -3182,11 +3784,57 @@ void FFTW_Slab::strain()
     }
   }
 
-  fftwnd_mpi_destroy_plan(iiplan);
-
   return;
 }
 
+#ifndef FFT_FFTW3
+
+/* -----------------------------------------------------------------------
+inverse FFT of the ND*ND displacement gradient components in data_strain
+---------------------------------------------------------------------*/
+void FFTW_Slab::backward_strain()
+{
+  int ND = dimension;
+  int SK = strain_stride;
+  int psys;
+  fftwnd_mpi_output_order order =
+    kspace_transposed ? FFTW_TRANSPOSED_ORDER : FFTW_NORMAL_ORDER;
+
+  if (r2c) {
+    for(int i=0;i<ND*ND;i++)
+      rfftwnd_mpi(riplan, 1, (fftw_real *) (data_strain+i*SK),
+        (fftw_real *) work_strain, order);
+    return;
+  }
+
+  // same grid and direction as iplan, the cache hands back that plan
+  fftwnd_mpi_plan iiplan = c2c_plan(FFTW_BACKWARD);
+
+  for(int i=0;i<ND;i++){
+    for (int j=0;j<ND;j++){
+      psys = i*SK + j*SK*ND;
+      fftwnd_mpi(iiplan, 1, data_strain+psys, work_strain, order); /* Inverse FFT (multiple)*/
+    }
+  }
+}
+
+/* -----------------------------------------------------------------------
+inverse FFT of the 3 components of grad(xi) in data_grad, as 3
+interleaved fields of one transform
+---------------------------------------------------------------------*/
+void FFTW_Slab::backward_gradient()
+{
+  fftwnd_mpi_output_order order =
+    kspace_transposed ? FFTW_TRANSPOSED_ORDER : FFTW_NORMAL_ORDER;
+
+  if (r2c)
+    rfftwnd_mpi(riplan, 3, (fftw_real *) data_grad, (fftw_real *) work, order);
+  else
+    fftwnd_mpi(iplan, 3, data_grad, work, order);
+}
+
+#endif
+
 /* -----------------------------------------------------------------------
 stress
 ---------------------------------------------------------------------*/
@@ -3201,7 +3849,7 @@ void FFTW_Slab::stress()
   int N3 = local_z;
   int NP = num_planes;
   int NS = slip_systems;
-  int nsize = N1*N2*N3;
+  int nsize = N1*ny*nz;
   int i, j, k, l, m, ida, idb, na, nb, na0, is, ia, ib, index;
   int na11, na12, na13, na21, na22, na23, na31, na32, na33, layer;
   int tcount[ND][ND], ccount[ND][ND], t_count[ND][ND], c_count[ND][ND];
@@ -3270,3 +3918,602 @@ void FFTW_Slab::stress()
     }
   }
 }
+
+/* ----------------------------------------------------------------------
+   all-to-all patterns and 1d plans of the mode 2 batch
+   k-space is FFTW's transposed order on more than one proc
+------------------------------------------------------------------------- */
+
+void FFTW_Slab::batch_setup()
+{
+  int N1 = nx;
+  int N2 = local_y;
+  int N3 = local_z;
+  int NS = slip_systems;
+
+  // sendbuf is also the scratch the FFTW 3 line plans are made on
+
+  if (kspace_transposed) {
+    memory->create(sendbuf,NS*total_local_size,"fft:sendbuf");
+    memory->create(recvbuf,NS*total_local_size,"fft:recvbuf");
+    transpose_setup(xy,yx,N3,total_local_size);
+  }
+  else memory->create(sendbuf,MAX(total_local_size,1),"fft:sendbuf");
+
+  // y lines are strided by a z row within one x plane of an x slab,
+  // z lines are contiguous, x lines are strided by a z row within one
+  // y plane of a y slab, or by a y,z plane on a single proc
+
+  int sign[2] = {FFTW_FORWARD, FFTW_BACKWARD};
+
+  for (int i = 0; i < 2; i++) {
+    if (kspace_transposed) xplan[i] = line_plan(N1,sign[i],N3,N3,1);
+    else xplan[i] = line_plan(N1,sign[i],N2*N3,N2*N3,1);
+    yplan[i] = line_plan(N2,sign[i],N3,N3,1);
+    zplan[i] = line_plan(N3,sign[i],MAX(local_x*N2,1),1,N3);
+  }
+}
+
+/* ----------------------------------------------------------------------
+   transposes between x slabs and FFTW's y slabs of fields n3 deep and
+   size apart, y slabs are stored y,x,z and both sides keep every field
+   in its own slot so the transposes work in place
+   the slabs are the ones FFTW reports and need not be balanced, every
+   proc learns the extents of all others
+------------------------------------------------------------------------- */
+
+void FFTW_Slab::transpose_setup(Remap &fwd, Remap &bwd, int n3, int size)
+{
+  int lNy = local_ny_after_trans;
+
+  int *xlo, *xn, *ylo, *yn;
+  memory->create(xlo,nprocs,"fft:xlo");
+  memory->create(xn,nprocs,"fft:xn");
+  memory->create(ylo,nprocs,"fft:ylo");
+  memory->create(yn,nprocs,"fft:yn");
+  MPI_Allgather(&local_x_start,1,MPI_INT,xlo,1,MPI_INT,world);
+  MPI_Allgather(&local_x,1,MPI_INT,xn,1,MPI_INT,world);
+  MPI_Allgather(&local_y_start_after_trans,1,MPI_INT,ylo,1,MPI_INT,world);
+  MPI_Allgather(&lNy,1,MPI_INT,yn,1,MPI_INT,world);
+
+  int xdim[3] = {local_x, local_y, n3};
+  int ydim[3] = {nx, lNy, n3};
+
+  remap_setup(fwd,world,xdim,ydim,1,0,ylo,yn,xlo,xn);
+  remap_setup(bwd,world,ydim,xdim,0,1,xlo,xn,ylo,yn);
+  fwd.outtrans = bwd.intrans = 1;
+  fwd.insize = fwd.outsize = size;
+  bwd.insize = bwd.outsize = size;
+
+  memory->destroy(xlo);
+  memory->destroy(xn);
+  memory->destroy(ylo);
+  memory->destroy(yn);
+}
+
+/* ----------------------------------------------------------------------
+   3d FFT of nf fields total_local_size apart, dir 0 forward 1 backward
+   y and z lines on x slabs, x lines on y slabs after one in-place
+   transpose of all nf fields; forward stops in transposed k-space and
+   backward starts from it, on a single proc there is no transpose
+------------------------------------------------------------------------- */
+
+void FFTW_Slab::batch_transform(FFT_DATA *data, int nf, int dir)
+{
+  int N1 = nx;
+  int N2 = local_y;
+  int N3 = local_z;
+  int DS = total_local_size;
+  int lNy = local_ny_after_trans;
+  int f, i;
+
+  if (kspace_transposed && dir == 1) {
+    for (f = 0; f < nf; f++)
+      for (i = 0; i < lNy; i++)
+        lines(xplan[dir],data + f*DS + i*N1*N3,N3,N3,1);
+    remap(data,data,nf,yx);
+  }
+
+  for (f = 0; f < nf; f++) {
+    for (i = 0; i < local_x; i++)
+      lines(yplan[dir],data + f*DS + i*N2*N3,N3,N3,1);
+    lines(zplan[dir],data + f*DS,local_x*N2,1,N3);
+  }
+
+  if (!kspace_transposed) {
+    for (f = 0; f < nf; f++)
+      lines(xplan[dir],data + f*DS,N2*N3,N2*N3,1);
+  }
+  else if (dir == 0) {
+    remap(data,data,nf,xy);
+    for (f = 0; f < nf; f++)
+      for (i = 0; i < lNy; i++)
+        lines(xplan[dir],data + f*DS + i*N1*N3,N3,N3,1);
+  }
+}
+
+/* -----------------------------------------------------------------------
+forward FFT, all slip systems in one batch
+---------------------------------------------------------------------*/
+void FFTW_Slab::forward_mode2()
+{
+  batch_transform(data_fftw,slip_systems,0);
+}
+
+/* -----------------------------------------------------------------------
+backward FFT, all slip systems in one batch
+---------------------------------------------------------------------*/
+void FFTW_Slab::backward_mode2()
+{
+  batch_transform(data_real,slip_systems,1);
+}
+
+/* ----------------------------------------------------------------------
+   glide planes of the sparse transform, order parameters of every slip
+   system live on a few z planes only, see glide_transform()
+   with glide_planes auto these are the planes where xi starts nonzero
+------------------------------------------------------------------------- */
+
+void FFTW_Slab::glide_setup()
+{
+  int N1 = nx;
+  int lN1 = local_x;
+  int N2 = local_y;
+  int N3 = local_z;
+  int NS = slip_systems;
+  int lNy = local_ny_after_trans;
+  int isa, i, j, k, p, na0;
+
+  if (pbuf) return;
+
+  // z planes holding a nonzero order parameter on any proc
+
+  int *flag, *flagall;
+  memory->create(flag,N3,"fft:flag");
+  memory->create(flagall,N3,"fft:flagall");
+  for (k = 0; k < N3; k++) flag[k] = 0;
+  for (isa = 0; isa < NS; isa++)
+    for (i = 0; i < lN1; i++)
+      for (j = 0; j < N2; j++)
+        for (k = 0; k < N3; k++) {
+          na0 = 2*(i*N2*N3 + j*N3 + k + isa*lN1*N2*N3);
+          if (xi[0][na0] != 0.0 || xi[0][na0+1] != 0.0) flag[k] = 1;
+        }
+  MPI_Allreduce(flag,flagall,N3,MPI_INT,MPI_MAX,world);
+
+  if (glide_auto) {
+    for (k = 0; k < N3; k++)
+      if (flagall[k]) {
+        memory->grow(glide_plane,nglide+1,"fft:glide_plane");
+        glide_plane[nglide++] = k;
+      }
+    if (nglide == 0)
+      error->all(FLERR,"fft_style glide_planes auto found no nonzero order parameter");
+  }
+
+  memory->create(zactive,N3,"fft:zactive");
+  for (k = 0; k < N3; k++) zactive[k] = 0;
+  for (p = 0; p < nglide; p++) {
+    if (glide_plane[p] < 0 || glide_plane[p] >= N3)
+      error->all(FLERR,"fft_style glide plane is outside the grid");
+    if (zactive[glide_plane[p]])
+      error->all(FLERR,"fft_style glide plane is listed twice");
+    zactive[glide_plane[p]] = 1;
+  }
+  for (k = 0; k < N3; k++)
+    if (flagall[k] && !zactive[k])
+      error->all(FLERR,"Order parameter is nonzero off the glide planes");
+
+  memory->destroy(flag);
+  memory->destroy(flagall);
+
+  // the glide planes of all slip systems, psize apart, go through the
+  // x and y lines of mode 2 with its transpose; sendbuf is the remap
+  // and planning scratch and may already be there from batch_setup()
+
+  int P = nglide;
+  psize = MAX(lN1*N2*P,1);
+  if (kspace_transposed) psize = MAX(psize,lNy*N1*P);
+  memory->create(pbuf,NS*psize,"fft:pbuf");
+
+  if (sendbuf == NULL) {
+    memory->create(sendbuf,NS*psize,"fft:sendbuf");
+    if (kspace_transposed) memory->create(recvbuf,NS*psize,"fft:recvbuf");
+  }
+  if (kspace_transposed) transpose_setup(pxy,pyx,P,psize);
+
+  int sign[2] = {FFTW_FORWARD, FFTW_BACKWARD};
+
+  for (i = 0; i < 2; i++) {
+    if (kspace_transposed) pxplan[i] = line_plan(N1,sign[i],P,P,1);
+    else pxplan[i] = line_plan(N1,sign[i],N2*P,N2*P,1);
+    pyplan[i] = line_plan(N2,sign[i],P,P,1);
+  }
+
+  // forward factors of the pruned DFT along z, kz*z reduced mod N3
+
+  double pi = acos(-1.0);
+  memory->create(ztwiddle,P*N3,"fft:ztwiddle");
+  for (p = 0; p < P; p++)
+    for (k = 0; k < N3; k++) {
+      double a = -2.0*pi*((k*glide_plane[p]) % N3)/N3;
+      ztwiddle[p*N3+k].re = cos(a);
+      ztwiddle[p*N3+k].im = sin(a);
+    }
+
+  if (me == 0) {
+    if (screen) fprintf(screen,"Sparse FFT on %d of %d z planes\n",P,N3);
+    if (logfile) fprintf(logfile,"Sparse FFT on %d of %d z planes\n",P,N3);
+  }
+}
+
+/* ----------------------------------------------------------------------
+   3d FFT of order parameters confined to the glide planes, dir 0 forward
+   from xi into data_fftw, 1 backward from data_real onto the glide planes
+   only; 2d FFTs of the P planes and a pruned DFT of P terms along z,
+   k-space comes out in the same layout as the full transform
+------------------------------------------------------------------------- */
+
+void FFTW_Slab::glide_transform(int dir)
+{
+  int N1 = nx;
+  int lN1 = local_x;
+  int N2 = local_y;
+  int N3 = local_z;
+  int NS = slip_systems;
+  int DS = total_local_size;
+  int lNy = local_ny_after_trans;
+  int P = nglide;
+  int nrow = local_kn1*local_kn2;
+  int f, i, j, k, p, na0;
+  double re, im;
+  FFT_DATA *in, *out, *tw;
+
+  if (dir == 0) {
+    for (f = 0; f < NS; f++)
+      for (i = 0; i < lN1; i++)
+        for (j = 0; j < N2; j++)
+          for (p = 0; p < P; p++) {
+            na0 = 2*(i*N2*N3 + j*N3 + glide_plane[p] + f*lN1*N2*N3);
+            out = pbuf + f*psize + (i*N2 + j)*P + p;
+            out->re = xi[0][na0];
+            out->im = xi[0][na0+1];
+          }
+
+    for (f = 0; f < NS; f++)
+      for (i = 0; i < lN1; i++)
+        lines(pyplan[0],pbuf + f*psize + i*N2*P,P,P,1);
+    if (kspace_transposed) {
+      remap(pbuf,pbuf,NS,pxy);
+      for (f = 0; f < NS; f++)
+        for (i = 0; i < lNy; i++)
+          lines(pxplan[0],pbuf + f*psize + i*N1*P,P,P,1);
+    }
+    else {
+      for (f = 0; f < NS; f++)
+        lines(pxplan[0],pbuf + f*psize,N2*P,N2*P,1);
+    }
+
+    for (f = 0; f < NS; f++)
+      for (i = 0; i < nrow; i++) {
+        in = pbuf + f*psize + i*P;
+        out = data_fftw + f*DS + i*N3;
+        for (k = 0; k < N3; k++) {
+          re = im = 0.0;
+          for (p = 0; p < P; p++) {
+            tw = ztwiddle + p*N3 + k;
+            re += in[p].re*tw->re - in[p].im*tw->im;
+            im += in[p].re*tw->im + in[p].im*tw->re;
+          }
+          out[k].re = re;
+          out[k].im = im;
+        }
+      }
+    return;
+  }
+
+  for (f = 0; f < NS; f++)
+    for (i = 0; i < nrow; i++) {
+      in = data_real + f*DS + i*N3;
+      out = pbuf + f*psize + i*P;
+      for (p = 0; p < P; p++) {
+        tw = ztwiddle + p*N3;
+        re = im = 0.0;
+        for (k = 0; k < N3; k++) {
+          re += in[k].re*tw[k].re + in[k].im*tw[k].im;
+          im += in[k].im*tw[k].re - in[k].re*tw[k].im;
+        }
+        out[p].re = re;
+        out[p].im = im;
+      }
+    }
+
+  if (kspace_transposed) {
+    for (f = 0; f < NS; f++)
+      for (i = 0; i < lNy; i++)
+        lines(pxplan[1],pbuf + f*psize + i*N1*P,P,P,1);
+    remap(pbuf,pbuf,NS,pyx);
+  }
+  else {
+    for (f = 0; f < NS; f++)
+      lines(pxplan[1],pbuf + f*psize,N2*P,N2*P,1);
+  }
+  for (f = 0; f < NS; f++)
+    for (i = 0; i < lN1; i++)
+      lines(pyplan[1],pbuf + f*psize + i*N2*P,P,P,1);
+
+  for (f = 0; f < NS; f++)
+    for (i = 0; i < lN1; i++)
+      for (j = 0; j < N2; j++)
+        for (p = 0; p < P; p++)
+          data_real[f*DS + i*N2*N3 + j*N3 + glide_plane[p]] =
+            pbuf[f*psize + (i*N2 + j)*P + p];
+}
+
+/* ----------------------------------------------------------------------
+   n points split over np procs, extent and first point of block ip
+   same rounding as the sub-domain bounds of procs2domain_3d()
+------------------------------------------------------------------------- */
+
+void FFTW_Slab::block(int n, int np, int ip, int &nlocal, int &start)
+{
+  start = (ip*n + np-1)/np;
+  nlocal = ((ip+1)*n + np-1)/np - start;
+}
+
+/* ----------------------------------------------------------------------
+   peer boxes of one transpose
+   the input is full along axis a and is cut into the peers' blocks,
+   the output is full along axis b and is filled from the peers' blocks
+   blocks are balanced unless the peers' first planes and extents along
+   a and b are given in alo,an and blo,bn
+   fields are stored x,y,z and are insize/outsize apart, callers may
+   change both afterwards
+------------------------------------------------------------------------- */
+
+void FFTW_Slab::remap_setup(Remap &rm, MPI_Comm comm, int *indim, int *outdim,
+                            int a, int b, int *alo, int *an, int *blo, int *bn)
+{
+  rm.comm = comm;
+  MPI_Comm_size(comm,&rm.np);
+  int np = rm.np;
+
+  memory->create(rm.sendlo,3*np,"fft:sendlo");
+  memory->create(rm.sendn,3*np,"fft:sendn");
+  memory->create(rm.recvlo,3*np,"fft:recvlo");
+  memory->create(rm.recvn,3*np,"fft:recvn");
+  memory->create(rm.sendcnt,np,"fft:sendcnt");
+  memory->create(rm.senddsp,np,"fft:senddsp");
+  memory->create(rm.recvcnt,np,"fft:recvcnt");
+  memory->create(rm.recvdsp,np,"fft:recvdsp");
+
+  rm.insize = indim[0]*indim[1]*indim[2];
+  rm.outsize = outdim[0]*outdim[1]*outdim[2];
+  rm.intrans = rm.outtrans = 0;
+  for (int d = 0; d < 3; d++) {
+    rm.indim[d] = indim[d];
+    rm.outdim[d] = outdim[d];
+  }
+
+  for (int p = 0; p < np; p++) {
+    for (int d = 0; d < 3; d++) {
+      rm.sendlo[3*p+d] = 0;
+      rm.sendn[3*p+d] = indim[d];
+      rm.recvlo[3*p+d] = 0;
+      rm.recvn[3*p+d] = outdim[d];
+    }
+    if (alo) {
+      rm.sendlo[3*p+a] = alo[p];
+      rm.sendn[3*p+a] = an[p];
+    } else block(indim[a],np,p,rm.sendn[3*p+a],rm.sendlo[3*p+a]);
+    if (blo) {
+      rm.recvlo[3*p+b] = blo[p];
+      rm.recvn[3*p+b] = bn[p];
+    } else block(outdim[b],np,p,rm.recvn[3*p+b],rm.recvlo[3*p+b]);
+    rm.sendcnt[p] = 2*rm.sendn[3*p]*rm.sendn[3*p+1]*rm.sendn[3*p+2];
+    rm.recvcnt[p] = 2*rm.recvn[3*p]*rm.recvn[3*p+1]*rm.recvn[3*p+2];
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FFTW_Slab::remap_destroy(Remap &rm)
+{
+  if (rm.np == 0) return;
+  memory->destroy(rm.sendlo);
+  memory->destroy(rm.sendn);
+  memory->destroy(rm.recvlo);
+  memory->destroy(rm.recvn);
+  memory->destroy(rm.sendcnt);
+  memory->destroy(rm.senddsp);
+  memory->destroy(rm.recvcnt);
+  memory->destroy(rm.recvdsp);
+  rm.np = 0;
+}
+
+/* ----------------------------------------------------------------------
+   move nf fields from one layout to another, in and out may be the same
+   fields are insize apart in in and outsize apart in out,
+   each peer's message holds its box for every field in turn
+------------------------------------------------------------------------- */
+
+void FFTW_Slab::remap(FFT_DATA *in, FFT_DATA *out, int nf, Remap &rm)
+{
+  int np = rm.np;
+  int p, f, i, j, lo0, lo1, lo2, n0, n1, n2, d0, d1, d2, row;
+  size_t nbytes;
+
+  int nsend = 0, nrecv = 0;
+  for (p = 0; p < np; p++) {
+    rm.senddsp[p] = nsend;
+    rm.recvdsp[p] = nrecv;
+    nsend += nf*rm.sendcnt[p];
+    nrecv += nf*rm.recvcnt[p];
+  }
+
+  // pack, z rows of a box are contiguous, a transposed layout is
+  // stored y,x,z; everything is packed before in is overwritten
+
+  FFT_DATA *buf = sendbuf;
+  d0 = rm.indim[0];
+  d1 = rm.indim[1];
+  d2 = rm.indim[2];
+  for (p = 0; p < np; p++) {
+    lo0 = rm.sendlo[3*p]; lo1 = rm.sendlo[3*p+1]; lo2 = rm.sendlo[3*p+2];
+    n0 = rm.sendn[3*p]; n1 = rm.sendn[3*p+1]; n2 = rm.sendn[3*p+2];
+    nbytes = n2*sizeof(FFT_DATA);
+    for (f = 0; f < nf; f++)
+      for (i = 0; i < n0; i++)
+        for (j = 0; j < n1; j++) {
+          if (rm.intrans) row = ((lo1+j)*d0 + lo0+i)*d2 + lo2;
+          else row = ((lo0+i)*d1 + lo1+j)*d2 + lo2;
+          memcpy(buf,in + f*rm.insize + row,nbytes);
+          buf += n2;
+        }
+  }
+
+  for (p = 0; p < np; p++) {
+    rm.sendcnt[p] *= nf;
+    rm.recvcnt[p] *= nf;
+  }
+  MPI_Alltoallv(sendbuf,rm.sendcnt,rm.senddsp,MPI_DOUBLE,
+                recvbuf,rm.recvcnt,rm.recvdsp,MPI_DOUBLE,rm.comm);
+  for (p = 0; p < np; p++) {
+    rm.sendcnt[p] /= nf;
+    rm.recvcnt[p] /= nf;
+  }
+
+  // unpack
+
+  buf = recvbuf;
+  d0 = rm.outdim[0];
+  d1 = rm.outdim[1];
+  d2 = rm.outdim[2];
+  for (p = 0; p < np; p++) {
+    lo0 = rm.recvlo[3*p]; lo1 = rm.recvlo[3*p+1]; lo2 = rm.recvlo[3*p+2];
+    n0 = rm.recvn[3*p]; n1 = rm.recvn[3*p+1]; n2 = rm.recvn[3*p+2];
+    nbytes = n2*sizeof(FFT_DATA);
+    for (f = 0; f < nf; f++)
+      for (i = 0; i < n0; i++)
+        for (j = 0; j < n1; j++) {
+          if (rm.outtrans) row = ((lo1+j)*d0 + lo0+i)*d2 + lo2;
+          else row = ((lo0+i)*d1 + lo1+j)*d2 + lo2;
+          memcpy(out + f*rm.outsize + row,buf,nbytes);
+          buf += n2;
+        }
+  }
+}
+
+/* ----------------------------------------------------------------------
+   howmany 1d transforms in place, FFTW 3 plans carry their own strides
+------------------------------------------------------------------------- */
+
+void FFTW_Slab::lines(fftw_plan p, FFT_DATA *data, int howmany,
+                      int stride, int dist)
+{
+  if (howmany == 0) return;
+#ifdef FFT_FFTW3
+  (void) stride;
+  (void) dist;
+  fftw_complex *d = reinterpret_cast<fftw_complex *>(data);
+  fftw_execute_dft(p,d,d);
+#else
+  fftw(p,howmany,data,stride,dist,NULL,0,0);
+#endif
+}
+
+/* ----------------------------------------------------------------------
+   cached plan matching kind, grid, direction and batch, NULL if none
+   every lookup counts as a hit or a miss
+------------------------------------------------------------------------- */
+
+void *FFTW_Slab::find_plan(int kind, int *n, int dir, int nf, int stride, int dist)
+{
+  for (int i = 0; i < nplans; i++) {
+    CachedPlan &cp = plans[i];
+    if (cp.kind == kind && cp.n[0] == n[0] && cp.n[1] == n[1] && cp.n[2] == n[2] &&
+        cp.dir == dir && cp.nf == nf && cp.stride == stride && cp.dist == dist) {
+      plan_hits++;
+      return cp.plan;
+    }
+  }
+  plan_misses++;
+  return NULL;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FFTW_Slab::add_plan(int kind, int *n, int dir, int nf, int stride, int dist,
+                         void *plan)
+{
+  if (nplans == maxplans) {
+    maxplans += 8;
+    plans = (CachedPlan *)
+      memory->srealloc(plans,maxplans*sizeof(CachedPlan),"fft:plans");
+  }
+
+  CachedPlan &cp = plans[nplans++];
+  cp.kind = kind;
+  for (int d = 0; d < 3; d++) cp.n[d] = n[d];
+  cp.dir = dir;
+  cp.nf = nf;
+  cp.stride = stride;
+  cp.dist = dist;
+  cp.plan = plan;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FFTW_Slab::destroy_plans()
+{
+  for (int i = 0; i < nplans; i++) {
+#ifdef FFT_FFTW3
+    fftw_destroy_plan((fftw_plan) plans[i].plan);
+#else
+    if (plans[i].kind == PLAN_C2C)
+      fftwnd_mpi_destroy_plan((fftwnd_mpi_plan) plans[i].plan);
+    else if (plans[i].kind == PLAN_R2C)
+      rfftwnd_mpi_destroy_plan((rfftwnd_mpi_plan) plans[i].plan);
+    else fftw_destroy_plan((fftw_plan) plans[i].plan);
+#endif
+  }
+  memory->sfree(plans);
+  plans = NULL;
+  nplans = maxplans = 0;
+}
+
+/* ----------------------------------------------------------------------
+   plan for howmany 1d transforms of length n in place
+   FFTW 3 plans carry their strides and are made on sendbuf as scratch,
+   measuring overwrites the array; FFTW 2 plans only depend on n and dir
+------------------------------------------------------------------------- */
+
+fftw_plan FFTW_Slab::line_plan(int n, int dir, int howmany, int stride, int dist)
+{
+  int nn[3] = {n, 1, 1};
+
+#ifdef FFT_FFTW3
+  fftw_plan p = (fftw_plan) find_plan(PLAN_LINES,nn,dir,howmany,stride,dist);
+  if (p) return p;
+
+  unsigned flags = FFTW_UNALIGNED | FFTW_ESTIMATE;
+  if (plan_effort == 1) flags = FFTW_UNALIGNED | FFTW_MEASURE;
+  else if (plan_effort == 2) flags = FFTW_UNALIGNED | FFTW_PATIENT;
+
+  fftw_complex *tmp = reinterpret_cast<fftw_complex *>(sendbuf);
+  p = fftw_plan_many_dft(1,&n,howmany,tmp,NULL,stride,dist,
+                         tmp,NULL,stride,dist,dir,flags);
+#else
+  howmany = stride = dist = 0;
+  fftw_plan p = (fftw_plan) find_plan(PLAN_LINES,nn,dir,howmany,stride,dist);
+  if (p) return p;
+
+  int flags = FFTW_ESTIMATE | FFTW_IN_PLACE;
+  if (plan_effort > 0) flags = FFTW_MEASURE | FFTW_IN_PLACE;
+  p = fftw_create_plan(n,(fftw_direction) dir,flags);
+#endif
+
+  if (p == NULL) error->all(FLERR,"Could not create FFT plan");
+  add_plan(PLAN_LINES,nn,dir,howmany,stride,dist,p);
+  return p;
+}
@@ -14,7 +14,9 @@ to reproduce, prepare derivative works, distribute copies to the public, perform
    ------------------------------------------------------------------------- */
 
 #ifdef FFT_CLASS
+#ifndef FFT_FFTW3
 FftStyle(fftw_slab,FFTW_Slab)
+#endif
 
 #else
 
@@ -24,21 +26,55 @@ FftStyle(fftw_slab,FFTW_Slab)
 #include "pointers.h"
 #include "mpi.h"
 #include "fft.h"
+#ifdef FFT_FFTW3
+#include "fftw3-mpi.h"
+#else
 #include "dfftw_mpi.h"
+#include "drfftw_mpi.h"
+#endif
 
 namespace PFDD_NS {
 
+  // complex data in the FFTW 2 layout, FFTW 3 stores the same two doubles
+  // as a double[2], see fft_fftw3_slab.h
+
+#ifdef FFT_FFTW3
+  typedef struct { double re, im; } FFT_DATA;
+#else
+  typedef fftw_complex FFT_DATA;
+#endif
+
   class FFTW_Slab : public FFT {
   public:
 
-    fftwnd_mpi_plan plan, iplan;
-    fftw_complex *data_fftw, *work, *data_real, *temp_data, *data_core, *data_strain, *work_strain;
+    FFT_DATA *data_fftw, *work, *data_real, *temp_data, *data_strain, *work_strain;
+    int strain_stride;      // complex elements per strain component in k-space
 
     FFTW_Slab(class PFDD_C *, int, char **);
     ~FFTW_Slab();
 
+    // FFTW 2.1.5 transforms, FFTW3_Slab provides these when built with -DFFT_FFTW3
+#ifndef FFT_FFTW3
+    fftwnd_mpi_plan plan, iplan;
+    rfftwnd_mpi_plan rplan, riplan;     // r2c yes
+
+    fftwnd_mpi_plan c2c_plan(int);
+    rfftwnd_mpi_plan r2c_plan(int);
+
     void create_plan();
     void init();
+    void forward_mode1();
+    void backward_mode1();
+    virtual void backward_strain();
+    virtual void backward_gradient();
+#else
+    virtual void backward_strain() = 0;
+    virtual void backward_gradient() = 0;
+#endif
+    void forward_mode2();
+    void backward_mode2();
+
+    void box_extremes();
     void setup();
     void rotate_stress(); // rotate stress from local to global
     void frec();
@@ -52,8 +88,18 @@ namespace PFDD_NS {
 
     void init_loop();
     void internal_energy();
-    void update_order_parameter();
+    void update_order_parameter(double);
     void prepare_next_itr();
+    void prepare_semi_implicit(double, double);
+    void implicit_solve(double, double);
+    void update_order_parameter_implicit();
+    void xi_force(double *);
+    void mobile_sites(double *);
+    void regrid(int, int, int);
+    void restrict_xi(int);
+    void load_xi();
+    void spectrum_xi();
+    void prolongate_xi(int, int, int);
     void temp_stor_data();
     void reset_data();
     void stressfree_strain();
@@ -64,21 +110,20 @@ namespace PFDD_NS {
     void resolSS_non_Schmid();
     //grad
     void gradient();
-    void core_energy_bcc_perfect();
-    void core_energy_perfect();
-    void core_energy_extended();
-    void core_energy_sine();
-    void core_energy_pyrII(); // Claire changed 8/1/18: was core_energy_isf_usf
-    void core_energy_USFE_angle_tau();
-    void core_energy_mpea();
+    virtual void skin_setup();
+    void skin_destroy();
+    void skin_start();
+    void skin_finish();
+    void gradient_plane(int);
+    void spectral_theta();
+    double line_angle(int, double, double, double);
+    double line_angle_global(int, double, double, double);
+    void sweep();
+    double sweep_plane(int);
     void project_core_energy();
     void allocate();
     void prep_forward();
-    void forward_mode1();
-    void forward_mode2();
     void prep_backward();
-    void backward_mode1();
-    void backward_mode2();
     void initial_sxtal_mode1();
     void initial_sxtal_NoLoop();
     void initial_sxtal_mode2();
@@ -95,6 +140,107 @@ namespace PFDD_NS {
     void initial_sxtal_3SBCC();
     void initial_sxtal_edge();
     void initial_sxtal_loop();
+
+  protected:
+
+    // batched transforms with our own transposes, all fields of a batch
+    // stay in place and share one all-to-all per transpose (mode 2)
+    // data moved between two layouts over a group of procs, boxes are
+    // 3 ints per peer in (x,y,z) order, counts in doubles per field
+
+    struct Remap {
+      MPI_Comm comm;
+      int np;
+      int insize,outsize;               // local points per field before/after
+      int indim[3],outdim[3];           // local extents before/after
+      int *sendlo,*sendn;               // box sent to each peer, input layout
+      int *recvlo,*recvn;               // box received from each peer, output layout
+      int *sendcnt,*senddsp,*recvcnt,*recvdsp;
+      int intrans,outtrans;             // 1 = stored y,x,z instead of x,y,z
+    };
+
+    FFT_DATA *sendbuf,*recvbuf;   // all-to-all buffers
+    Remap xy,yx;
+
+    fftw_plan xplan[2],yplan[2],zplan[2];   // 1d plans, [0] forward [1] backward
+
+    // sparse transform of xi confined to a few z glide planes, 2d FFTs of
+    // those planes and a pruned DFT along z
+
+    int *zactive;                 // 1 for a glide plane, NULL = full transform
+    int psize;                    // complex elements per slip system in pbuf
+    FFT_DATA *pbuf;               // glide planes of all slip systems
+    FFT_DATA *ztwiddle;           // exp(-2 pi i kz z/nz) of each glide plane
+    Remap pxy,pyx;
+    fftw_plan pxplan[2],pyplan[2];
+
+    // BB and FF of a k-point in closed form from fx,fy,fz and the
+    // k-independent contractions of C and eps, made once in Bmatrix()
+
+    double *bb_e;                 // eps_a:C:eps_b of each pair ka <= kb
+    double *bb_s;                 // C:eps_a of each slip system, 3x3
+    double *bbt;                  // BB of one block of k-points, matrix_free only
+    double *ffk;                  // F of one k-point, matrix_free only
+    double *chol;                 // NS x NS factor and NS right hand sides, implicit_solve()
+
+    double *skin;                 // x faces of xi sent and received in gradient()
+    MPI_Request skin_req[4];      // persistent sends/recvs of the faces
+    int nskin_req;                // 0 on 1 proc
+    double *dskin;                // delta of the x faces, see project_core_energy()
+    MPI_Request dskin_req[2];     // persistent send/recv of dskin
+    int ndskin_req;               // 0 to 2, the x ends of the box send less
+    FFT_DATA *data_grad;          // 3 components of grad(xi) for gradient spectral
+    int grad_interleaved;         // 1 = the components of a point are adjacent in data_grad
+    double *gsin;                 // sin(2 pi k/n) along x, y and z, nx+ny+nz
+    int spectrum_ready;           // 1 = sweep() left the forward transform in data_fftw
+
+    // one grid's xi carried over regrid() by coarse_start(), this proc's
+    // planes along the slab axis until level_remap() hands them out
+
+    FFT_DATA *lvl_buf;            // fields of the other grid, NULL between uses
+    int lvl_lo,lvl_n;             // first global plane and planes in lvl_buf
+    int lvl_dim[3];               // local extents of one field of lvl_buf
+
+    void deallocate();
+
+    // every FFTW plan comes from this cache and lives until the style is
+    // deleted, a plan is found again by kind, grid, direction and batch
+
+    enum {PLAN_C2C, PLAN_R2C, PLAN_LINES};
+
+    struct CachedPlan {
+      int kind;                   // PLAN_C2C, PLAN_R2C or PLAN_LINES
+      int n[3];                   // grid, n,1,1 for 1d lines
+      int dir;                    // FFTW sign or r2c direction
+      int nf;                     // fields or lines transformed together
+      int stride,dist;            // 1d lines in FFTW 3 only
+      void *plan;
+    };
+
+    int nplans,maxplans;
+    CachedPlan *plans;
+
+    void *find_plan(int, int *, int, int, int, int);
+    void add_plan(int, int *, int, int, int, int, void *);
+    void destroy_plans();
+    fftw_plan line_plan(int, int, int, int, int);
+
+    void batch_setup();
+    void batch_transform(FFT_DATA *, int, int);
+    void transpose_setup(Remap &, Remap &, int, int);
+    void bb_setup();
+    void bb_block(int, int, double *, int);
+    void ff_point(int, double *, int);
+    void glide_setup();
+    void glide_transform(int);
+    void lines(fftw_plan, FFT_DATA *, int, int, int);
+    void remap_setup(Remap &, MPI_Comm, int *, int *, int, int,
+                     int *alo = NULL, int *an = NULL,
+                     int *blo = NULL, int *bn = NULL);
+    void remap_destroy(Remap &);
+    void remap(FFT_DATA *, FFT_DATA *, int, Remap &);
+    void block(int, int, int, int &, int &);
+    void level_remap(FFT_DATA *, int, int, int);
   };
 
 }
@@ -135,4 +281,39 @@ namespace PFDD_NS {
 
    There can only be 1 proc in the z dimension for 2d models.
 
+   E: fft_style r2c requires mode 1
+
+   The batched mode 2 transforms are complex to complex only.
+
+   E: fft_style glide_planes requires r2c no
+
+   The sparse glide plane transform is complex to complex only.
+
+   E: fft_style glide_planes auto found no nonzero order parameter
+
+   Glide planes are detected from the initial configuration, which has
+   no dislocation.
+
+   E: fft_style glide plane is outside the grid
+
+   Glide planes are z indices from 0 to nz-1.
+
+   E: fft_style glide plane is listed twice
+
+   Self-explanatory.
+
+   E: Order parameter is nonzero off the glide planes
+
+   The initial configuration has dislocations on z planes that are not
+   listed after glide_planes.
+
+   E: Could not create FFT plan
+
+   FFTW returned a NULL plan for the grid and planner effort.
+
+   E: Semi-implicit matrix is not positive definite
+
+   (1 + CD*dt*stab) I + CD*dt*BB could not be factored at some k-point, the interaction
+   matrix of the slip systems has a negative eigenvalue.
+
 */
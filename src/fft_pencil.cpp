@@ -0,0 +1,395 @@
+/* ----------------------------------------------------------------------
+PFDD -- Phase Field Dislocation Dynamics
+
+© 2022. Triad National Security, LLC. All rights reserved.
+This program was produced under U.S. Government contract 89233218CNA000001 for
+Los Alamos National Laboratory (LANL), which is operated by Triad National
+Security, LLC for the U.S. Department of Energy/National Nuclear Security
+Administration. All rights in the program are reserved by Triad National
+Security, LLC, and the U.S. Department of Energy/National Nuclear Security
+Administration. The Government is granted for itself and others acting on its
+behalf a nonexclusive, paid-up, irrevocable worldwide license in this material 
+to reproduce, prepare derivative works, distribute copies to the public, perform
+ publicly and display publicly, and to permit others to do so.
+------------------------------------------------------------------------- */
+
+#include "math.h"
+#include "mpi.h"
+#include "string.h"
+#include "fft_pencil.h"
+#include "app.h"
+#include "memory.h"
+#include "error.h"
+
+using namespace PFDD_NS;
+
+/* ---------------------------------------------------------------------- */
+
+FFTW_Pencil::FFTW_Pencil(PFDD_C *pfdd_p, int narg, char **arg) :
+  FFTW_Slab(pfdd_p,narg,arg)
+{
+  if (r2c) error->all(FLERR,"fft_style pencil does not support r2c");
+  if (nglide || glide_auto)
+    error->all(FLERR,"fft_style pencil does not support glide_planes");
+
+  // x stays whole, the y,z split is chosen in procs2domain_3d()
+
+  user_procgrid[0] = user_procgrid[1] = user_procgrid[2] = 0;
+
+  // k-space comes back in the x pencils of real space
+  kspace_transposed = 0;
+  grad_interleaved = 0;
+
+  comm_y = comm_z = MPI_COMM_NULL;
+  ybuf = zbuf = NULL;
+  yhalo = zhalo = NULL;
+  yz.np = zy.np = 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+FFTW_Pencil::~FFTW_Pencil()
+{
+  remap_destroy(yz);
+  remap_destroy(zy);
+  if (comm_y != MPI_COMM_NULL) MPI_Comm_free(&comm_y);
+  if (comm_z != MPI_COMM_NULL) MPI_Comm_free(&comm_z);
+
+  memory->destroy(ybuf);
+  memory->destroy(zbuf);
+  memory->destroy(yhalo);
+  memory->destroy(zhalo);
+}
+
+/* ----------------------------------------------------------------------
+   1 by py by pz grid, y and z split so as to minimize the perimeter
+   of the y,z face of a pencil
+------------------------------------------------------------------------- */
+
+void FFTW_Pencil::procs2domain_3d()
+{
+  user_procgrid[0] = 1;
+  procs2grid_2d(nprocs,yprd,zprd,user_procgrid[1],user_procgrid[2]);
+
+  FFT::procs2domain_3d();
+}
+
+/* ----------------------------------------------------------------------
+   initialize the pencils
+   real space and k-space are both x pencils: all of x, a block of y
+   and a block of z, stored x,y,z with z fastest like the slabs
+------------------------------------------------------------------------- */
+
+void FFTW_Pencil::init()
+{
+  stress_inc = app->stoptime;
+  dimension = app->dimension;
+  sigma = app->sigma;
+  deltasig = app->deltasig;
+
+  if (dimension != 3) error->all(FLERR,"fft_style pencil requires a 3d simulation");
+
+  npy = procgrid[1];
+  npz = procgrid[2];
+  ipy = myloc[1];
+  ipz = myloc[2];
+
+  MPI_Comm_split(world,ipz,ipy,&comm_y);
+  MPI_Comm_split(world,ipy,ipz,&comm_z);
+
+  /* pencil decomposition */
+
+  local_x = nx;
+  local_x_start = 0;
+  block(ny,npy,ipy,local_y,local_y_start);
+  block(nz,npz,ipz,local_z,local_z_start);
+  local_kz = local_z;
+  local_ny_after_trans = local_y;
+  local_y_start_after_trans = local_y_start;
+  total_local_size = local_x*local_y*local_z;
+
+  // y pencils split x over comm_y, z pencils split y over comm_z
+
+  block(nx,npy,ipy,ylx,ylx_start);
+  zlx = ylx;
+  block(ny,npz,ipz,zly,zly_start);
+
+  int flag = 0, flagall;
+  if (local_y == 0 || local_z == 0 || ylx == 0 || zly == 0) flag = 1;
+  MPI_Allreduce(&flag,&flagall,1,MPI_INT,MPI_MAX,world);
+  if (flagall) error->all(FLERR,"fft_style pencil has more procs than grid planes");
+
+  flag = (app->nlocal != total_local_size);
+  MPI_Allreduce(&flag,&flagall,1,MPI_INT,MPI_MAX,world);
+  if (flagall)
+    error->all(FLERR,"Pencil decomposition does not match the sites owned by this proc");
+
+  // allocate arrays
+  allocate();
+
+  create_plan();
+
+  box_extremes();
+}
+
+/* ----------------------------------------------------------------------
+   pencil buffers, all-to-all patterns and 1d plans along x, y and z
+------------------------------------------------------------------------- */
+
+void FFTW_Pencil::create_plan()
+{
+  int N1 = nx;
+  int N2 = ny;
+  int N3 = nz;
+  int xsize = total_local_size;
+  int ysize = ylx*N2*local_z;
+  int zsize = zlx*zly*N3;
+  int maxsize = MAX(xsize,MAX(ysize,zsize));
+
+  nbatch = (mode == 2) ? slip_systems : 1;
+  if (grad_spectral) nbatch = MAX(nbatch,3);
+
+  memory->create(ybuf,nbatch*ysize,"pencil:ybuf");
+  memory->create(zbuf,nbatch*zsize,"pencil:zbuf");
+  memory->create(sendbuf,nbatch*maxsize,"pencil:sendbuf");
+  memory->create(recvbuf,nbatch*maxsize,"pencil:recvbuf");
+  memory->create(yhalo,4*slip_systems*N1*local_z,"pencil:yhalo");
+  memory->create(zhalo,4*slip_systems*N1*local_y,"pencil:zhalo");
+
+  int xdim[3] = {N1, local_y, local_z};
+  int ydim[3] = {ylx, N2, local_z};
+  int zdim[3] = {zlx, zly, N3};
+
+  remap_setup(xy,comm_y,xdim,ydim,0,1);
+  remap_setup(yz,comm_z,ydim,zdim,1,2);
+  remap_setup(zy,comm_z,zdim,ydim,2,1);
+  remap_setup(yx,comm_y,ydim,xdim,1,0);
+
+  // x lines are strided by a y,z plane, y lines by a z row within one
+  // x plane of a y pencil, z lines are contiguous
+
+  int sign[2] = {FFTW_FORWARD, FFTW_BACKWARD};
+
+  for (int i = 0; i < 2; i++) {
+    xplan[i] = line_plan(N1,sign[i],local_y*local_z,local_y*local_z,1);
+    yplan[i] = line_plan(N2,sign[i],local_z,local_z,1);
+    zplan[i] = line_plan(N3,sign[i],zlx*zly,1,N3);
+  }
+
+  if (wisdom_file && me == 0)
+    error->warning(FLERR,"FFT wisdom file requires fft_style fftw3_slab, ignored");
+}
+
+/* ----------------------------------------------------------------------
+   3d FFT of nf x pencil fields lN1*N2*N3 apart, dir 0 forward 1 backward
+   x lines in place, then y and z lines after transposes to y and z
+   pencils and back; a transpose over a single proc is skipped since the
+   two layouts are then the same
+------------------------------------------------------------------------- */
+
+void FFTW_Pencil::transform(FFT_DATA *data, int nf, int dir)
+{
+  int N2 = ny;
+  int N3 = nz;
+  int xsize = total_local_size;
+  int ysize = ylx*N2*local_z;
+  int zsize = zlx*zly*N3;
+  int f, i;
+
+  for (f = 0; f < nf; f++)
+    lines(xplan[dir],data + f*xsize,local_y*local_z,local_y*local_z,1);
+
+  FFT_DATA *ydata = data;
+  if (npy > 1) {
+    remap(data,ybuf,nf,xy);
+    ydata = ybuf;
+  }
+
+  for (f = 0; f < nf; f++)
+    for (i = 0; i < ylx; i++)
+      lines(yplan[dir],ydata + f*ysize + i*N2*local_z,local_z,local_z,1);
+
+  FFT_DATA *zdata = ydata;
+  if (npz > 1) {
+    remap(ydata,zbuf,nf,yz);
+    zdata = zbuf;
+  }
+
+  for (f = 0; f < nf; f++)
+    lines(zplan[dir],zdata + f*zsize,zlx*zly,1,N3);
+
+  if (npz > 1) remap(zbuf,ydata,nf,zy);
+  if (npy > 1) remap(ybuf,data,nf,yx);
+}
+
+/* -----------------------------------------------------------------------
+forward FFT
+---------------------------------------------------------------------*/
+void FFTW_Pencil::forward_mode1()
+{
+  int NS = slip_systems;
+
+  for(int i=0; i<NS; i++)
+    transform(data_fftw + i*total_local_size,1,0);
+}
+
+/* -----------------------------------------------------------------------
+forward FFT, all slip systems in one pass
+---------------------------------------------------------------------*/
+void FFTW_Pencil::forward_mode2()
+{
+  transform(data_fftw,slip_systems,0);
+}
+
+/* -----------------------------------------------------------------------
+backward FFT
+---------------------------------------------------------------------*/
+void FFTW_Pencil::backward_mode1()
+{
+  int NS = slip_systems;
+
+  for(int i=0; i<NS; i++)
+    transform(data_real + i*total_local_size,1,1);
+}
+
+/* -----------------------------------------------------------------------
+backward FFT, all slip systems in one pass
+---------------------------------------------------------------------*/
+void FFTW_Pencil::backward_mode2()
+{
+  transform(data_real,slip_systems,1);
+}
+
+/* -----------------------------------------------------------------------
+inverse FFT of the ND*ND displacement gradient components in data_strain
+---------------------------------------------------------------------*/
+void FFTW_Pencil::backward_strain()
+{
+  int ND = dimension;
+  int SK = strain_stride;
+
+  for(int i=0;i<ND;i++)
+    for (int j=0;j<ND;j++)
+      transform(data_strain + i*SK + j*SK*ND,1,1);
+}
+
+/* -----------------------------------------------------------------------
+inverse FFT of the 3 components of grad(xi) in data_grad, one batch
+---------------------------------------------------------------------*/
+void FFTW_Pencil::backward_gradient()
+{
+  transform(data_grad,3,1);
+}
+
+/* ----------------------------------------------------------------------
+grad(xi) and line character angle theta
+x lines are whole and periodic on every proc, the y and z neighbors
+across the pencil faces come from one plane exchange in each direction
+------------------------------------------------------------------------- */
+void FFTW_Pencil::gradient()
+{
+  int isa, i, j, k, index, ih;
+  int lN1 = local_x;
+  int N2 = local_y;
+  int N3 = local_z;
+  int NS = slip_systems;
+  int nyh = NS*lN1*N3;              // points in one y face, all systems
+  int nzh = NS*lN1*N2;              // points in one z face, all systems
+  double xl, xr, yl, yr, zl, zr;
+  MPI_Status status;
+
+  if (grad_spectral) {
+    prepare_next_itr();
+    prep_forward();
+    spectral_theta();
+    return;
+  }
+
+  // halo layout: [0] my low face, [1] my high face, [2] ghost below, [3] ghost above
+
+  for(isa=0;isa<NS;isa++)
+    for(i=0;i<lN1;i++){
+      for(k=0;k<N3;k++){
+        ih = k + i*N3 + isa*lN1*N3;
+        yhalo[ih] = xi[0][2*(i*N2*N3 + k + isa*lN1*N2*N3)];
+        yhalo[ih+nyh] = xi[0][2*(i*N2*N3 + (N2-1)*N3 + k + isa*lN1*N2*N3)];
+      }
+      for(j=0;j<N2;j++){
+        ih = j + i*N2 + isa*lN1*N2;
+        zhalo[ih] = xi[0][2*(i*N2*N3 + j*N3 + isa*lN1*N2*N3)];
+        zhalo[ih+nzh] = xi[0][2*(i*N2*N3 + j*N3 + N3-1 + isa*lN1*N2*N3)];
+      }
+    }
+
+  int ydown = (ipy-1+npy) % npy, yup = (ipy+1) % npy;
+  int zdown = (ipz-1+npz) % npz, zup = (ipz+1) % npz;
+
+  MPI_Sendrecv(&yhalo[0],nyh,MPI_DOUBLE,ydown,0,
+               &yhalo[3*nyh],nyh,MPI_DOUBLE,yup,0,comm_y,&status);
+  MPI_Sendrecv(&yhalo[nyh],nyh,MPI_DOUBLE,yup,1,
+               &yhalo[2*nyh],nyh,MPI_DOUBLE,ydown,1,comm_y,&status);
+  MPI_Sendrecv(&zhalo[0],nzh,MPI_DOUBLE,zdown,0,
+               &zhalo[3*nzh],nzh,MPI_DOUBLE,zup,0,comm_z,&status);
+  MPI_Sendrecv(&zhalo[nzh],nzh,MPI_DOUBLE,zup,1,
+               &zhalo[2*nzh],nzh,MPI_DOUBLE,zdown,1,comm_z,&status);
+
+  for(isa=0;isa<NS;isa++){
+    for(i=0;i<lN1;i++)
+    for(j=0;j<N2;j++)
+    for(k=0;k<N3;k++){
+      index = i*N2*N3 + j*N3 + k + isa*lN1*N2*N3;
+
+      xl = xi[0][2*(index + (i == 0 ? lN1-1 : -1)*N2*N3)];
+      xr = xi[0][2*(index + (i == lN1-1 ? 1-lN1 : 1)*N2*N3)];
+
+      ih = k + i*N3 + isa*lN1*N3;
+      yl = (j == 0) ? yhalo[ih+2*nyh] : xi[0][2*(index-N3)];
+      yr = (j == N2-1) ? yhalo[ih+3*nyh] : xi[0][2*(index+N3)];
+
+      ih = j + i*N2 + isa*lN1*N2;
+      zl = (k == 0) ? zhalo[ih+2*nzh] : xi[0][2*(index-1)];
+      zr = (k == N3-1) ? zhalo[ih+3*nzh] : xi[0][2*(index+1)];
+
+      theta[index] = line_angle(isa,(xr-xl)/2,(yr-yl)/2,(zr-zl)/2);
+    }//ijk
+  }//isa
+}
+
+/* ----------------------------------------------------------------------
+x lines are whole on every proc, so there are no x faces to exchange
+and none of the slab's persistent requests are made
+------------------------------------------------------------------------- */
+void FFTW_Pencil::skin_setup()
+{
+  skin_destroy();
+}
+
+/* ----------------------------------------------------------------------
+start of an iteration, pass by pass: the gradient needs the y and z
+halos of the whole pencil before any plane is done
+------------------------------------------------------------------------- */
+void FFTW_Pencil::sweep()
+{
+  init_loop();
+
+  // the step's forward transform, kept for the solver, theta from it
+  if (grad_spectral) {
+    prepare_next_itr();
+    prep_forward();
+    spectral_theta();
+    spectrum_ready = 1;
+  }
+  else gradient();
+
+  app->core_energy();
+  if (!spectrum_ready) prepare_next_itr();
+}
+
+/* ----------------------------------------------------------------------
+   the pencils must match the sites, see init()
+------------------------------------------------------------------------- */
+
+void FFTW_Pencil::regrid(int, int, int)
+{
+  error->all(FLERR,"fft_style pencil does not support solve_style GL coarsen");
+}
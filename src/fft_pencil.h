@@ -0,0 +1,108 @@
+/* ----------------------------------------------------------------------
+PFDD -- Phase Field Dislocation Dynamics
+
+© 2022. Triad National Security, LLC. All rights reserved.
+This program was produced under U.S. Government contract 89233218CNA000001 for
+Los Alamos National Laboratory (LANL), which is operated by Triad National
+Security, LLC for the U.S. Department of Energy/National Nuclear Security
+Administration. All rights in the program are reserved by Triad National
+Security, LLC, and the U.S. Department of Energy/National Nuclear Security
+Administration. The Government is granted for itself and others acting on its
+behalf a nonexclusive, paid-up, irrevocable worldwide license in this material 
+to reproduce, prepare derivative works, distribute copies to the public, perform
+ publicly and display publicly, and to permit others to do so.
+   ------------------------------------------------------------------------- */
+
+#ifdef FFT_CLASS
+FftStyle(pencil,FFTW_Pencil)
+
+#else
+
+#ifndef PFDD_FFT_PENCIL_H
+#define PFDD_FFT_PENCIL_H
+
+#include "fft_fftw_slab.h"
+
+namespace PFDD_NS {
+
+  // same physics as FFTW_Slab on a 2d y,z decomposition, every proc
+  // holds whole x lines and does its own transposes, so the run scales
+  // past nx procs; k-space is returned in the real space layout
+
+  class FFTW_Pencil : public FFTW_Slab {
+  public:
+
+    FFTW_Pencil(class PFDD_C *, int, char **);
+    ~FFTW_Pencil();
+
+    void procs2domain_3d();
+    void create_plan();
+    void init();
+    void forward_mode1();
+    void forward_mode2();
+    void backward_mode1();
+    void backward_mode2();
+    void backward_strain();
+    void backward_gradient();
+    void gradient();
+    void skin_setup();
+    void sweep();
+    void regrid(int, int, int);
+
+  private:
+
+    int npy,npz;                  // procs splitting y and z
+    int ipy,ipz;                  // my location in the proc grid
+    MPI_Comm comm_y,comm_z;       // procs in my z block (vary in y), my y block (vary in z)
+
+    int ylx,ylx_start;            // y pencils: local x extent, full y, local_z
+    int zlx,zly,zly_start;        // z pencils: local x and y extents, full z
+    int nbatch;                   // fields transformed together, NS in mode 2, 3 or more for gradient spectral
+
+    FFT_DATA *ybuf,*zbuf;         // data in the y and z pencil layouts
+    double *yhalo,*zhalo;         // ghost planes for gradient()
+
+    Remap yz,zy;                  // xy and yx come with the slab
+
+    void transform(FFT_DATA *, int, int);
+  };
+
+}
+
+#endif
+#endif
+
+/* ERROR/WARNING messages:
+
+   E: fft_style pencil does not support r2c
+
+   The pencil transforms are complex to complex only.
+
+   E: fft_style pencil does not support glide_planes
+
+   Use a slab style for the sparse glide plane transform.
+
+   E: fft_style pencil does not support solve_style GL coarsen
+
+   The pencils are fixed by the sites each proc owns, use a slab style
+   to relax on a coarser grid first.
+
+   E: fft_style pencil requires a 3d simulation
+
+   Use fftw_slab for 1d and 2d models.
+
+   E: fft_style pencil has more procs than grid planes
+
+   Every proc needs at least one y and z plane in the x pencils and one
+   x and y plane in the y and z pencils.  Use fewer procs.
+
+   E: Pencil decomposition does not match the sites owned by this proc
+
+   The sites from create_sites are not on the grid points of the x pencil,
+   the box is likely not a multiple of the lattice spacing.
+
+   W: FFT wisdom file requires fft_style fftw3_slab, ignored
+
+   Only the FFTW 3 slab style keeps wisdom.
+
+*/
@@ -18,6 +18,7 @@ to reproduce, prepare derivative works, distribute copies to the public, perform
 #include "stdio.h"
 #include "finish.h"
 #include "timer.h"
+#include "fft.h"
 #include "memory.h"
 
 using namespace PFDD_NS;
@@ -54,6 +55,16 @@ Finish::Finish (PFDD_C *pfdd_p, int flag) : Pointers(pfdd_p)
 	      "Loop time of %g on %d procs\n",time_loop,nprocs);
   }
 
+  // FFT setup of the Green's function tables, before the loop
+
+  time = timer->array[TIME_SETUP];
+  MPI_Allreduce(&time,&tmp,1,MPI_DOUBLE,MPI_SUM,world);
+  time = tmp/nprocs;
+  if (me == 0) {
+    if (screen) fprintf(screen,"Setup time = %g\n",time);
+    if (logfile) fprintf(logfile,"Setup time = %g\n",time);
+  }
+
   if (flag == 0) return;
 
   if (me == 0) {
@@ -124,6 +135,17 @@ Finish::Finish (PFDD_C *pfdd_p, int flag) : Pointers(pfdd_p)
     if (logfile) 
       fprintf(logfile,"Other time (%%) = %g (%g)\n",time,time/time_loop*100.0);
   }
+
+  // FFT plans made (misses) and reused (hits) on proc 0
+
+  if (me == 0) {
+    if (screen)
+      fprintf(screen,"FFT plan cache = %d hits %d misses\n",
+              fft->plan_hits,fft->plan_misses);
+    if (logfile)
+      fprintf(logfile,"FFT plan cache = %d hits %d misses\n",
+              fft->plan_hits,fft->plan_misses);
+  }
 }
 
 /* ---------------------------------------------------------------------- */
@@ -21,6 +21,7 @@ to reproduce, prepare derivative works, distribute copies to the public, perform
 #include "style_dump.h"
 #include "style_diag.h"
 #include "app.h"
+#include "solve.h"
 #include "dump.h"
 #include "diag.h"
 #include "timer.h"
@@ -338,6 +339,11 @@ void Output::stats(int timeflag)
     strpnt += strlen(strpnt);
   }
 
+  if (solve) {
+    solve->stats(strpnt);
+    strpnt += strlen(strpnt);
+  }
+
   for (int i = 0; i < ndiag; i++)
     if (diaglist[i]->stats_flag) {
       diaglist[i]->stats(strpnt);
@@ -369,6 +375,11 @@ void Output::stats_header()
   sprintf(strpnt," %10s","CPU");
   strpnt += strlen(strpnt);
 
+  if (solve) {
+    solve->stats_header(strpnt);
+    strpnt += strlen(strpnt);
+  }
+
   for (int i = 0; i < ndiag; i++)
     if (diaglist[i]->stats_flag) {
       diaglist[i]->stats_header(strpnt);
@@ -36,6 +36,10 @@ class Solve : protected Pointers {
   // pure virtual functions, must be defined in child class
   virtual void iterate() = 0;
 
+  // columns added to the stats output, none by default
+  virtual void stats(char *strtmp) {strtmp[0] = '\0';};
+  virtual void stats_header(char *strtmp) {strtmp[0] = '\0';};
+
 };
 
 }
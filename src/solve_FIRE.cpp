@@ -0,0 +1,250 @@
+/* ----------------------------------------------------------------------
+PFDD -- Phase Field Dislocation Dynamics
+
+© 2022. Triad National Security, LLC. All rights reserved.
+This program was produced under U.S. Government contract 89233218CNA000001 for
+Los Alamos National Laboratory (LANL), which is operated by Triad National
+Security, LLC for the U.S. Department of Energy/National Nuclear Security
+Administration. All rights in the program are reserved by Triad National
+Security, LLC, and the U.S. Department of Energy/National Nuclear Security
+Administration. The Government is granted for itself and others acting on its
+behalf a nonexclusive, paid-up, irrevocable worldwide license in this material 
+to reproduce, prepare derivative works, distribute copies to the public, perform
+ publicly and display publicly, and to permit others to do so.
+------------------------------------------------------------------------- */
+
+#include "mpi.h"
+#include "math.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "solve_FIRE.h"
+#include "memory.h"
+#include "error.h"
+#include "timer.h"
+#include "fft.h"
+#include "app.h"
+#include "output.h"
+
+using namespace PFDD_NS;
+
+/* ---------------------------------------------------------------------- */
+
+SolveFIRE::SolveFIRE(PFDD_C *pfdd_p, int narg, char **arg) :
+Solve(pfdd_p, narg, arg)
+{
+  it = 0;
+  max_iter = 10;
+  sstate = 0;
+  tol = 0.0;
+
+  dt = dt_min = dt_max = 0.0;
+  alpha0 = 0.1;
+  n_min = 5;
+  f_inc = 1.1;
+  f_dec = 0.5;
+  f_alpha = 0.99;
+  ndown = nrestart = 0;
+
+  nxi = 0;
+  f = v = NULL;
+
+  int iarg = 1;
+  while (iarg < narg) {
+    if (iarg+2 > narg) error->all(FLERR,"Illegal solve_style command");
+    if (strcmp(arg[iarg],"max_iter") == 0) {
+      max_iter = atoi(arg[iarg+1]);
+    }
+    else if (strcmp(arg[iarg],"tol") == 0) {
+      tol = atof(arg[iarg+1]);
+    }
+    else if (strcmp(arg[iarg],"dt_min") == 0) {
+      dt_min = atof(arg[iarg+1]);
+      if (dt_min <= 0.0) error->all(FLERR,"Illegal solve_style command");
+    }
+    else if (strcmp(arg[iarg],"dt_max") == 0) {
+      dt_max = atof(arg[iarg+1]);
+      if (dt_max <= 0.0) error->all(FLERR,"Illegal solve_style command");
+    }
+    else if (strcmp(arg[iarg],"alpha") == 0) {
+      alpha0 = atof(arg[iarg+1]);
+      if (alpha0 <= 0.0 || alpha0 >= 1.0)
+        error->all(FLERR,"Illegal solve_style command");
+    }
+    else if (strcmp(arg[iarg],"n_min") == 0) {
+      n_min = atoi(arg[iarg+1]);
+      if (n_min < 0) error->all(FLERR,"Illegal solve_style command");
+    }
+    else error->all(FLERR,"Illegal solve_style command");
+    iarg += 2;
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+SolveFIRE::~SolveFIRE()
+{
+  memory->destroy(f);
+  memory->destroy(v);
+}
+
+/* ----------------------------------------------------------------------
+   FIRE (Bitzek et al., PRL 97, 170201, 2006) with the restart rules of
+   FIRE 2.0 (Guenole et al., Comput. Mater. Sci. 175, 109584, 2020), on
+   xi with unit mass and the GL rate as force; from rest the first step
+   moves xi by dt^2 f, dt times a GL step dt, and the velocity then
+   builds up over the downhill steps; each step costs the same force
+   evaluation, one forward and one backward FFT, as a GL step
+   converged when the GL increment of one app timestep, |f| timestep,
+   is below tol
+------------------------------------------------------------------------- */
+
+void SolveFIRE::iterate()
+{
+  int ND = app->dimension;
+  int stopsteps = app->stopsteps;
+  double *x;
+  double sum[2], sumall[2], p, fnorm, vnorm, mix;
+  int i;
+
+  if (dt_max == 0.0) dt_max = 10.0*app->timestep;
+  if (dt_min == 0.0) dt_min = 0.5*app->timestep;
+  if (dt_min > dt_max) error->all(FLERR,"Illegal solve_style command");
+
+  nxi = 2*fft->slip_systems*fft->local_x*fft->local_y*fft->local_z;
+  memory->destroy(f);
+  memory->destroy(v);
+  memory->create(f,nxi,"solve:f");
+  memory->create(v,nxi,"solve:v");
+
+  timer->stamp();
+
+  if(me == 0){
+    printf("Beginning FIRE relaxation\n");
+  }
+
+  for(sstate = 0; sstate<stopsteps; sstate++){  // Loop on stress states
+    fft->rotate_stress();
+    app->resolSS();
+
+    // each stress state starts at rest
+    for (i = 0; i < nxi; i++) v[i] = 0.0;
+    dt = MAX(dt_min,MIN(app->timestep,dt_max));
+    alpha = alpha0;
+    ndown = 0;
+
+    for(int it=0; it<max_iter; it++){
+      // forces on xi, as in GL
+      fft->sweep();
+      fft->prep_forward();
+      fft->internal_energy();
+      fft->prep_backward();
+      fft->xi_force(f);
+
+      x = fft->xi[0];
+
+      sum[0] = sum[1] = 0.0;
+      for (i = 0; i < nxi; i++) {
+        sum[0] += f[i]*v[i];
+        sum[1] += f[i]*f[i];
+      }
+      MPI_Allreduce(sum,sumall,2,MPI_DOUBLE,MPI_SUM,world);
+      p = sumall[0];
+      fnorm = sqrt(sumall[1]);
+
+      int converged = (fnorm*app->timestep < tol);
+
+      if (!converged) {
+        // downhill: the step grows and the mixing decays after n_min
+        // steps in a row
+        if (p > 0.0) {
+          if (++ndown > n_min) {
+            dt = MIN(dt*f_inc,dt_max);
+            alpha *= f_alpha;
+          }
+        }
+        // uphill: back half a step and stop, the step is cut unless
+        // still in the first n_min steps of the stress state
+        else if (p < 0.0) {
+          for (i = 0; i < nxi; i++) {
+            x[i] -= 0.5*dt*v[i];
+            v[i] = 0.0;
+          }
+          ndown = 0;
+          nrestart++;
+          if (it >= n_min) dt = MAX(dt*f_dec,dt_min);
+          alpha = alpha0;
+        }
+
+        // semi-implicit Euler, velocity turned toward the force
+        sum[0] = 0.0;
+        for (i = 0; i < nxi; i++) {
+          v[i] += dt*f[i];
+          sum[0] += v[i]*v[i];
+        }
+        MPI_Allreduce(sum,sumall,1,MPI_DOUBLE,MPI_SUM,world);
+        vnorm = sqrt(sumall[0]);
+        mix = fnorm > 0.0 ? alpha*vnorm/fnorm : 0.0;
+        for (i = 0; i < nxi; i++) {
+          v[i] = (1.0-alpha)*v[i] + mix*f[i];
+          x[i] += dt*v[i];
+        }
+      }
+
+      if (converged || fft->ximin > 1 || it == max_iter-1){
+        if(me==0)
+          printf("printing output it %d\n",it);
+        app->nextoutput = output->compute(app->time,1);
+      }
+      else if (app->time >= app->nextoutput){
+        app->nextoutput = output->compute(app->time,0);
+      }
+      timer->stamp(TIME_OUTPUT);
+
+      if(app->non_Schmid)
+        fft->project_core_energy();
+
+      timer->stamp(TIME_FFT);
+
+      app->time++;
+
+      if(converged){
+        if(me==0)
+          printf("Loading step %d converged after %d iterations\n",sstate,it);
+        break;
+      }
+      if(fft->ximin > 1){
+        if(me==0)
+          printf("Minimum order parameter > 1 on slip plane (exiting)\n");
+        it=max_iter;
+        sstate=stopsteps;
+      }
+    }
+
+    // increment sigma
+    for (int i=0; i<ND; i++){
+      for (int j=0; j<ND; j++){
+        fft->sigma[i][j] = fft->sigma[i][j] + fft->deltasig[i][j];
+      }
+    }
+  }
+  timer->stamp(TIME_SOLVE);
+}
+
+/* ----------------------------------------------------------------------
+   print stats, MD step and velocity restarts so far
+------------------------------------------------------------------------- */
+
+void SolveFIRE::stats(char *strtmp)
+{
+  sprintf(strtmp," %10g %10d",dt,nrestart);
+}
+
+/* ----------------------------------------------------------------------
+   print stats header
+------------------------------------------------------------------------- */
+
+void SolveFIRE::stats_header(char *strtmp)
+{
+  sprintf(strtmp," %10s %10s","Dt","Restart");
+}
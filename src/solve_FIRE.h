@@ -0,0 +1,69 @@
+/* ----------------------------------------------------------------------
+PFDD -- Phase Field Dislocation Dynamics
+
+© 2022. Triad National Security, LLC. All rights reserved.
+This program was produced under U.S. Government contract 89233218CNA000001 for
+Los Alamos National Laboratory (LANL), which is operated by Triad National
+Security, LLC for the U.S. Department of Energy/National Nuclear Security
+Administration. All rights in the program are reserved by Triad National
+Security, LLC, and the U.S. Department of Energy/National Nuclear Security
+Administration. The Government is granted for itself and others acting on its
+behalf a nonexclusive, paid-up, irrevocable worldwide license in this material 
+to reproduce, prepare derivative works, distribute copies to the public, perform
+ publicly and display publicly, and to permit others to do so.
+------------------------------------------------------------------------- */
+
+#ifdef SOLVE_CLASS
+SolveStyle(FIRE,SolveFIRE)
+
+#else
+
+#ifndef PFDD_SOLVE_FIRE_H
+#define PFDD_SOLVE_FIRE_H
+
+#include "solve.h"
+
+namespace PFDD_NS {
+
+// relaxes xi at each stress state with the FIRE minimizer, the forces
+// are those of GL so only the relaxed state matches, not the path
+
+class SolveFIRE : public Solve {
+ public:
+  SolveFIRE(class PFDD_C *, int, char **);
+  ~SolveFIRE();
+
+  void iterate();
+  void stats(char *);
+  void stats_header(char *);
+
+ protected:
+  double dt;            // current MD step
+  double dt_min;        // smallest MD step, 0 = half the app timestep
+  double dt_max;        // largest MD step, 0 = 10 app timesteps
+  double alpha;         // current velocity mixing
+  double alpha0;        // mixing after a restart
+  int n_min;            // steps downhill before dt and alpha change
+  double f_inc,f_dec;   // dt growth and cut
+  double f_alpha;       // alpha decay
+  int ndown;            // steps downhill since the last restart
+  int nrestart;         // velocity restarts, P <= 0
+
+  int nxi;              // local length of xi
+  double *f;            // force on xi, -CD dE/dxi
+  double *v;            // velocity of xi
+};
+
+}
+
+#endif
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Illegal solve_style command
+
+Self-explanatory.  Check the input script syntax and compare to the
+documentation for the command.
+
+*/
@@ -13,6 +13,7 @@ to reproduce, prepare derivative works, distribute copies to the public, perform
  publicly and display publicly, and to permit others to do so.
 ------------------------------------------------------------------------- */
 
+#include "mpi.h"
 #include "math.h"
 #include "stdio.h"
 #include "stdlib.h"
@@ -25,6 +26,7 @@ to reproduce, prepare derivative works, distribute copies to the public, perform
 #include "timer.h"
 #include "fft.h"
 #include "app.h"
+#include "core_energy.h"
 #include "output.h"
 
 using namespace PFDD_NS;
@@ -41,19 +43,88 @@ Solve(pfdd_p, narg, arg)
   max_iter = 10;
   sstate = 0;
 
+  adaptive = 0;
+  dt = dtstep = dtprev = 0.0;
+  dt_min = dt_max = 0.0;
+  dt_grow = 1.1;
+  dt_lo = dt_hi = 0.0;
+  naccept = nreject = 0;
+  nxi = 0;
+  havev = 0;
+  xold = vold = NULL;
+
+  nanderson = 0;
+  beta = 1.0;
+  nhist = ahead = 0;
+  xprev = rprev = NULL;
+  dx = dr = gram = NULL;
+
+  npredict = 0;
+  nconv = chead = 0;
+  xconv = NULL;
+  tauprev = nmobile = NULL;
+
+  coarsen = 1;
+  check_every = 1;
+
   int iarg = 1;
   while (iarg < narg) {
-    if (strcmp(arg[iarg],"max_iter") == 0) {
-      iarg += 1;
-      max_iter = atoi(arg[iarg]);
-      iarg += 1;
+    int n = loop_keyword(narg,arg,iarg);
+    if (n) iarg += n;
+    else if (strcmp(arg[iarg],"adaptive") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal solve_style command");
+      if (strcmp(arg[iarg+1],"yes") == 0) adaptive = 1;
+      else if (strcmp(arg[iarg+1],"no") == 0) adaptive = 0;
+      else error->all(FLERR,"Illegal solve_style command");
+      iarg += 2;
+    }
+    else if (strcmp(arg[iarg],"dt_min") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal solve_style command");
+      dt_min = atof(arg[iarg+1]);
+      if (dt_min <= 0.0) error->all(FLERR,"Illegal solve_style command");
+      iarg += 2;
+    }
+    else if (strcmp(arg[iarg],"dt_max") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal solve_style command");
+      dt_max = atof(arg[iarg+1]);
+      if (dt_max <= 0.0) error->all(FLERR,"Illegal solve_style command");
+      iarg += 2;
+    }
+    else if (strcmp(arg[iarg],"dt_grow") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal solve_style command");
+      dt_grow = atof(arg[iarg+1]);
+      if (dt_grow < 1.0) error->all(FLERR,"Illegal solve_style command");
+      iarg += 2;
     }
-    else if (strcmp(arg[iarg],"tol") == 0) {
-      iarg += 1;
-      tol = atof(arg[iarg]);
-      iarg += 1;
+    else if (strcmp(arg[iarg],"anderson") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal solve_style command");
+      nanderson = atoi(arg[iarg+1]);
+      if (nanderson < 0) error->all(FLERR,"Illegal solve_style command");
+      iarg += 2;
     }
+    else if (strcmp(arg[iarg],"beta") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal solve_style command");
+      beta = atof(arg[iarg+1]);
+      if (beta <= 0.0 || beta > 1.0) error->all(FLERR,"Illegal solve_style command");
+      iarg += 2;
+    }
+    else if (strcmp(arg[iarg],"predict") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal solve_style command");
+      if (strcmp(arg[iarg+1],"none") == 0) npredict = 0;
+      else if (strcmp(arg[iarg+1],"linear") == 0) npredict = 1;
+      else if (strcmp(arg[iarg+1],"quadratic") == 0) npredict = 2;
+      else error->all(FLERR,"Illegal solve_style command");
+      iarg += 2;
+    }
+    else error->all(FLERR,"Illegal solve_style command");
   }
+
+  if (dt_min > 0.0 && dt_max > 0.0 && dt_min > dt_max)
+    error->all(FLERR,"Illegal solve_style command");
+  if (adaptive && nanderson)
+    error->all(FLERR,"solve_style GL adaptive and anderson cannot be combined");
+  if (nanderson && check_every > 1)
+    error->all(FLERR,"solve_style GL anderson needs check_every 1");
 }
 
 /* ---------------------------------------------------------------------- */
@@ -61,6 +132,16 @@ Solve(pfdd_p, narg, arg)
 SolveGL::~SolveGL()
 {
   delete random;
+  memory->destroy(xold);
+  memory->destroy(vold);
+  memory->destroy(xprev);
+  memory->destroy(rprev);
+  memory->destroy(dx);
+  memory->destroy(dr);
+  memory->destroy(gram);
+  memory->destroy(xconv);
+  memory->destroy(tauprev);
+  memory->destroy(nmobile);
   //memory->destroy(prob);
 }
 
@@ -72,8 +153,50 @@ void SolveGL::iterate()
   int ND = app->dimension;
   int stopsteps = app->stopsteps;
 
+  if (adaptive) {
+    if (dt_min == 0.0) dt_min = 0.01*app->timestep;
+    if (dt_max == 0.0) dt_max = 100.0*app->timestep;
+    if (dt_min > dt_max) error->all(FLERR,"Illegal solve_style command");
+
+    nxi = 2*fft->slip_systems*fft->local_x*fft->local_y*fft->local_z;
+    memory->destroy(xold);
+    memory->destroy(vold);
+    memory->create(xold,nxi,"solve:xold");
+    memory->create(vold,nxi,"solve:vold");
+  }
+
+  if (nanderson) {
+    nxi = 2*fft->slip_systems*fft->local_x*fft->local_y*fft->local_z;
+    memory->destroy(xold);
+    memory->destroy(xprev);
+    memory->destroy(rprev);
+    memory->destroy(dx);
+    memory->destroy(dr);
+    memory->destroy(gram);
+    memory->create(xold,nxi,"solve:xold");
+    memory->create(xprev,nxi,"solve:xprev");
+    memory->create(rprev,nxi,"solve:rprev");
+    memory->create(dx,nanderson,nxi,"solve:dx");
+    memory->create(dr,nanderson,nxi,"solve:dr");
+    memory->create(gram,nanderson,nanderson,"solve:gram");
+  }
+
+  if (npredict) {
+    nxi = 2*fft->slip_systems*fft->local_x*fft->local_y*fft->local_z;
+    memory->destroy(xconv);
+    memory->destroy(tauprev);
+    memory->destroy(nmobile);
+    memory->create(xconv,npredict+1,nxi,"solve:xconv");
+    memory->create(tauprev,fft->slip_systems,"solve:tauprev");
+    memory->create(nmobile,fft->slip_systems,"solve:nmobile");
+    fft->mobile_sites(nmobile);
+    nconv = 0;
+  }
+
   timer->stamp();
 
+  if (coarsen > 1) coarse_start();
+
   if(me == 0){
     printf("Beginning Time Evolution\n");
   }
@@ -82,17 +205,34 @@ void SolveGL::iterate()
     fft->rotate_stress();
     app->resolSS();
 
+    // each stress state starts again from the app's timestep, the rates
+    // of the previous state say nothing about the error after the jump
+    if (adaptive) {
+      dt = MAX(dt_min,MIN(dt_max,app->timestep));
+      havev = 0;
+    }
+    // extrapolated start, kept only if its first residual is below the
+    // one the previous converged state has under the new stress
+    int predicted = 0, stored = 0;
+    double xinorm_plain = 0.0;
+    if (npredict && nconv > 1) {
+      xinorm_plain = plain_residual();
+      predict_start();
+      predicted = 1;
+    }
+
+    nhist = 0;
+    int havex = 0;
+    int ndecay = 0;
+    double xinorm_last = 0.0;
+
 
     // GL minimization
 
     for(int it=0; it<max_iter; it++){
-      // Initialize fft arrays
-      fft->init_loop();
-      // Gradient and theta calculation
-      fft->gradient();
-      // Calculate the core energy
-      app->core_energy();
-      //
+      // theta, core energy and xi into the FFT input in one pass
+      fft->sweep();
+
       // Application specific fft forward
       fft->prep_forward();
 
@@ -102,10 +242,62 @@ void SolveGL::iterate()
       // Take inverse FFT
       fft->prep_backward();
 
+      // the residual is reduced every check_every steps, on the first
+      // step of an extrapolated start and on the last
+      int check = (it+1) % check_every == 0 || it == max_iter-1 ||
+        (predicted && it == 0);
+      fft->check_norm = check;
+
       // Update Order Parameter
-      fft->update_order_parameter();
+      int accepted = 1;
+      if (nanderson) {
+        double *x = fft->xi[0];
+        for (int i = 0; i < nxi; i++) xold[i] = x[i];
+      }
+      if (adaptive) accepted = adaptive_step();
+      else fft->update_order_parameter(app->timestep);
+
+      // convergence of the rate, per timestep, when the step varies
+      double xinorm = fft->xinorm;
+      if (adaptive) xinorm *= app->timestep/dtstep;
+      int converged = check && accepted && xinorm < tol;
+
+      if (predicted && it == 0 && xinorm > xinorm_plain) {
+        double *x = fft->xi[0];
+        for (int i = 0; i < nxi; i++) x[i] = xconv[chead][i];
+        if (adaptive) {
+          dt = MAX(dt_min,MIN(dt_max,app->timestep));
+          havev = 0;
+        }
+        converged = 0;
+        if(me==0)
+          printf("Loading step %d predictor rejected, residual %g > %g\n",
+                 sstate,xinorm,xinorm_plain);
+      }
 
-      if (fft->xinorm < tol || fft->ximin > 1 || it == max_iter-1){
+      // mixing starts in the geometric tail, once the residual fell m
+      // times in a row, and stops with its history when it grows again
+      if (nanderson) {
+        if (it > 0 && xinorm < xinorm_last) ndecay++;
+        else ndecay = havex = nhist = 0;
+        xinorm_last = xinorm;
+      }
+
+      // mixed step from the plain one unless it is the last
+      if (nanderson && !converged && ndecay >= nanderson) {
+        if (havex) anderson_step();
+        else {
+          double *x = fft->xi[0];
+          for (int i = 0; i < nxi; i++) {
+            xprev[i] = xold[i];
+            rprev[i] = x[i] - xold[i];
+            x[i] = xold[i] + beta*rprev[i];
+          }
+          havex = 1;
+        }
+      }
+
+      if (converged || fft->ximin > 1 || it == max_iter-1){
         if(me==0)
           printf("printing output it %d\n",it);
         app->nextoutput = output->compute(app->time,1);
@@ -115,8 +307,6 @@ void SolveGL::iterate()
       }
       timer->stamp(TIME_OUTPUT);
 
-      fft->prepare_next_itr();
-
       //compute delta, ddelta
       if(app->non_Schmid)
       	fft->project_core_energy();
@@ -134,7 +324,12 @@ void SolveGL::iterate()
 
 
       // Exit if converged
-      if(fft->xinorm < tol){
+      if(converged){
+        if (npredict) {
+          xinorm_conv = xinorm;
+          store_converged();
+          stored = 1;
+        }
         if(me==0)
           printf("Loading step %d converged after %d iterations\n",sstate,it);
         break;
@@ -147,6 +342,9 @@ void SolveGL::iterate()
       }
 
     }
+    // an unconverged state is no base for extrapolation
+    if (npredict && !stored) nconv = 0;
+
     // increment sigma
     for (int i=0; i<ND; i++){
       for (int j=0; j<ND; j++){
@@ -154,5 +352,338 @@ void SolveGL::iterate()
       }
     }
   }
+  fft->check_norm = 1;
   timer->stamp(TIME_SOLVE);
 }
+
+/* ----------------------------------------------------------------------
+   one explicit step with the step size adapted to the energy change;
+   with v = -CD dE/dxi, the last step dxi = dtprev vold changed the
+   energy by -dtprev (|vold|^2 + v.vold)/(2 CD) to second order, so with
+   r = v.vold/|vold|^2 it raised the energy if r < -1: it is then
+   undone and redone shorter from vold, and this step is not taken
+   0 > r >= -1 means the stiffest modes oscillate, the step is cut,
+   otherwise it grows by dt_grow; returns 1 if this step was taken
+------------------------------------------------------------------------- */
+
+int SolveGL::adaptive_step()
+{
+  double *x = fft->xi[0];
+  double v, r, sum[2], sumall[2], dtnew;
+  int i;
+
+  for (i = 0; i < nxi; i++) xold[i] = x[i];
+
+  fft->update_order_parameter(dt);
+
+  dtnew = dt;
+  if (havev) {
+    sum[0] = sum[1] = 0.0;
+    for (i = 0; i < nxi; i++) {
+      v = (x[i] - xold[i])/dt;
+      sum[0] += vold[i]*vold[i];
+      sum[1] += v*vold[i];
+    }
+    MPI_Allreduce(sum,sumall,2,MPI_DOUBLE,MPI_SUM,world);
+    r = sumall[0] > 0.0 ? sumall[1]/sumall[0] : 0.0;
+
+    if (r < -1.0 && dtprev > dt_min) {
+      nreject++;
+      dtnew = MAX(dt_min,0.5*dtprev);
+      for (i = 0; i < nxi; i++)
+        x[i] = xold[i] + (dtnew - dtprev)*vold[i];
+      dtprev = dtstep = dt = dtnew;
+      dt_lo = MIN(dt_lo,dtnew);
+      return 0;
+    }
+
+    if (r < 0.0) dtnew = MAX(dt_min,0.8*dt);
+    else dtnew = MIN(dt_max,dt_grow*dt);
+  }
+
+  for (i = 0; i < nxi; i++) vold[i] = (x[i] - xold[i])/dt;
+  havev = 1;
+  dtprev = dt;
+
+  if (naccept == 0) dt_lo = dt_hi = dt;
+  dt_lo = MIN(dt_lo,dt);
+  dt_hi = MAX(dt_hi,dt);
+  naccept++;
+
+  dtstep = dt;
+  dt = dtnew;
+  return 1;
+}
+
+/* ----------------------------------------------------------------------
+   Anderson (Pulay) mixing, xi holds the plain step G(x) from x = xold
+   with residual r = G(x) - x; the differences of the last m iterates
+   and residuals give the gamma minimizing |r - dR gamma|, and
+     x_new = x + beta r - (dX + beta dR) gamma
+   only the new row of dR^T dR and dR^T r are summed over the procs
+------------------------------------------------------------------------- */
+
+void SolveGL::anderson_step()
+{
+  double *x = fft->xi[0];
+  int m = nanderson;
+  int i, j, k, slot, n;
+  double r, sum[2*m], sumall[2*m], a[m][m], g[m];
+
+  // newest differences go over the oldest slot
+
+  ahead = (ahead + 1) % m;
+  if (nhist < m) nhist++;
+  double *dxs = dx[ahead];
+  double *drs = dr[ahead];
+  for (i = 0; i < nxi; i++) {
+    r = x[i] - xold[i];
+    dxs[i] = xold[i] - xprev[i];
+    drs[i] = r - rprev[i];
+    xprev[i] = xold[i];
+    rprev[i] = r;
+  }
+
+  // slots from the newest back, dR_j.dR_new and dR_j.r
+
+  for (j = 0; j < 2*nhist; j++) sum[j] = 0.0;
+  for (j = 0; j < nhist; j++) {
+    slot = (ahead - j + m) % m;
+    double *drj = dr[slot];
+    for (i = 0; i < nxi; i++) {
+      sum[j] += drj[i]*drs[i];
+      sum[nhist+j] += drj[i]*rprev[i];
+    }
+  }
+  MPI_Allreduce(sum,sumall,2*nhist,MPI_DOUBLE,MPI_SUM,world);
+
+  for (j = 0; j < nhist; j++) {
+    slot = (ahead - j + m) % m;
+    gram[ahead][slot] = gram[slot][ahead] = sumall[j];
+  }
+
+  // Cholesky of the Gram matrix, slightly regularized, a history that
+  // is numerically dependent is dropped and the step taken as is
+
+  n = nhist;
+  for (j = 0; j < n; j++) {
+    for (k = 0; k <= j; k++)
+      a[j][k] = gram[(ahead - j + m) % m][(ahead - k + m) % m];
+    a[j][j] *= 1.0 + 1.0e-10;
+    g[j] = sumall[nhist+j];
+  }
+
+  for (j = 0; j < n; j++) {
+    r = a[j][j];
+    for (k = 0; k < j; k++) r -= a[j][k]*a[j][k];
+    if (r <= 1.0e-14*a[j][j]) {
+      nhist = 0;
+      if (beta != 1.0)
+        for (i = 0; i < nxi; i++) x[i] = xold[i] + beta*rprev[i];
+      return;
+    }
+    a[j][j] = sqrt(r);
+    for (i = j+1; i < n; i++) {
+      r = a[i][j];
+      for (k = 0; k < j; k++) r -= a[i][k]*a[j][k];
+      a[i][j] = r/a[j][j];
+    }
+  }
+  for (j = 0; j < n; j++) {
+    for (k = 0; k < j; k++) g[j] -= a[j][k]*g[k];
+    g[j] /= a[j][j];
+  }
+  for (j = n-1; j >= 0; j--) {
+    for (k = j+1; k < n; k++) g[j] -= a[k][j]*g[k];
+    g[j] /= a[j][j];
+  }
+
+  for (i = 0; i < nxi; i++) x[i] = xold[i] + beta*rprev[i];
+  for (j = 0; j < n; j++) {
+    slot = (ahead - j + m) % m;
+    double *dxj = dx[slot];
+    double *drj = dr[slot];
+    for (i = 0; i < nxi; i++) x[i] -= g[j]*(dxj[i] + beta*drj[i]);
+  }
+}
+
+/* ----------------------------------------------------------------------
+   keywords of the GL loop that GL_semi_implicit takes too: max_iter,
+   tol, coarsen and check_every at arg[iarg], returns the args used,
+   0 if arg[iarg] is none of them
+------------------------------------------------------------------------- */
+
+int SolveGL::loop_keyword(int narg, char **arg, int iarg)
+{
+  if (strcmp(arg[iarg],"max_iter") != 0 && strcmp(arg[iarg],"tol") != 0 &&
+      strcmp(arg[iarg],"coarsen") != 0 && strcmp(arg[iarg],"check_every") != 0)
+    return 0;
+  if (iarg+2 > narg) error->all(FLERR,"Illegal solve_style command");
+
+  if (strcmp(arg[iarg],"max_iter") == 0) max_iter = atoi(arg[iarg+1]);
+  else if (strcmp(arg[iarg],"tol") == 0) tol = atof(arg[iarg+1]);
+  else if (strcmp(arg[iarg],"coarsen") == 0) {
+    coarsen = atoi(arg[iarg+1]);
+    if (coarsen < 1) error->all(FLERR,"Illegal solve_style command");
+  }
+  else {
+    check_every = atoi(arg[iarg+1]);
+    if (check_every < 1) error->all(FLERR,"Illegal solve_style command");
+  }
+  return 2;
+}
+
+/* ----------------------------------------------------------------------
+   relax the first stress state on the grid coarser by coarsen, which
+   starts from every coarsen-th site of xi and the obstacles, then go
+   back to the input grid with the coarse spectrum zero-padded
+   a coarse cell is coarsen input cells wide: the elastic energy of a
+   slip distribution grows with the cell size, the core energy and the
+   work of the applied stress with its square, so the elastic term is
+   weighted 1/coarsen against them for the same equilibrium
+------------------------------------------------------------------------- */
+
+void SolveGL::coarse_start()
+{
+  int NS = fft->slip_systems;
+  int nx = fft->nx, ny = fft->ny, nz = fft->nz;
+  int n1 = nx/coarsen, n2 = ny/coarsen, n3 = nz/coarsen;
+  int nlocal = fft->local_x*fft->local_y*fft->local_z;
+  double *xisave, *xosave;
+  int i, it;
+
+  if (fft->nglide || fft->glide_auto)
+    error->all(FLERR,"solve_style GL coarsen does not support glide_planes");
+  if (app->core && app->core->grid_data)
+    error->all(FLERR,"solve_style GL coarsen does not support core_energy mpea");
+  if (app->dimension != 3)
+    error->all(FLERR,"solve_style GL coarsen requires a 3d app");
+  if (nx % coarsen || ny % coarsen || nz % coarsen)
+    error->all(FLERR,"solve_style GL coarsen does not divide the grid");
+
+  // the input grid's xi and obstacles come back with it
+
+  memory->create(xisave,2*NS*nlocal,"solve:xisave");
+  memory->create(xosave,NS*nlocal,"solve:xosave");
+  for (i = 0; i < 2*NS*nlocal; i++) xisave[i] = fft->xi[0][i];
+  for (i = 0; i < NS*nlocal; i++) xosave[i] = fft->xo[i];
+
+  fft->restrict_xi(coarsen);
+  fft->regrid(n1,n2,n3);
+  fft->load_xi();
+  fft->hgrid = coarsen;
+  fft->setup();
+
+  fft->rotate_stress();
+  app->resolSS();
+
+  for (it = 0; it < max_iter; it++) {
+    fft->sweep();
+    fft->prep_forward();
+    fft->internal_energy();
+    fft->prep_backward();
+    fft->check_norm = (it+1) % check_every == 0 || it == max_iter-1;
+    fft->update_order_parameter(app->timestep);
+    if (app->non_Schmid) fft->project_core_energy();
+    if ((fft->check_norm && fft->xinorm < tol) || fft->ximin > 1) break;
+  }
+  fft->check_norm = 1;
+  if (me == 0)
+    printf("Coarse grid %dx%dx%d relaxed in %d iterations\n",n1,n2,n3,it);
+
+  fft->spectrum_xi();
+  fft->regrid(nx,ny,nz);
+  fft->hgrid = 1.0;
+  for (i = 0; i < 2*NS*nlocal; i++) fft->xi[0][i] = xisave[i];
+  for (i = 0; i < NS*nlocal; i++) fft->xo[i] = xosave[i];
+  fft->setup();
+  fft->prolongate_xi(n1,n2,n3);
+  memory->destroy(xisave);
+  memory->destroy(xosave);
+
+  // arrays the app and the output hold were made again
+  app->grow_app();
+}
+
+/* ----------------------------------------------------------------------
+   keep the converged xi and its resolved shear stresses, the newest
+  going over the oldest slot
+------------------------------------------------------------------------- */
+
+void SolveGL::store_converged()
+{
+  double *x = fft->xi[0];
+
+  chead = (chead + 1) % (npredict+1);
+  double *xc = xconv[chead];
+  for (int i = 0; i < nxi; i++) xc[i] = x[i];
+  for (int isa = 0; isa < fft->slip_systems; isa++) tauprev[isa] = fft->tau[isa];
+  if (nconv <= npredict) nconv++;
+}
+
+/* ----------------------------------------------------------------------
+   xi extrapolated to the next stress state through the converged ones,
+   the increments being equal: linear 2x0 - x1, quadratic 3x0 - 3x1 + x2
+------------------------------------------------------------------------- */
+
+void SolveGL::predict_start()
+{
+  double *x = fft->xi[0];
+  int n = npredict+1;
+  double *x0 = xconv[chead];
+  double *x1 = xconv[(chead+n-1) % n];
+  int i;
+
+  if (npredict == 1 || nconv == 2)
+    for (i = 0; i < nxi; i++) x[i] = 2.0*x0[i] - x1[i];
+  else {
+    double *x2 = xconv[(chead+n-2) % n];
+    for (i = 0; i < nxi; i++) x[i] = 3.0*(x0[i] - x1[i]) + x2[i];
+  }
+}
+
+/* ----------------------------------------------------------------------
+   first residual of the unextrapolated start: the rates of the newest
+   converged xi only change by CD times the change of tau on each
+   mobile site, taken as uncorrelated with its residual at convergence
+------------------------------------------------------------------------- */
+
+double SolveGL::plain_residual()
+{
+  double sum = 0.0, dtau;
+
+  for (int isa = 0; isa < fft->slip_systems; isa++) {
+    dtau = fft->tau[isa] - tauprev[isa];
+    sum += nmobile[isa]*dtau*dtau;
+  }
+  return sqrt(xinorm_conv*xinorm_conv +
+              app->CD*app->CD*app->timestep*app->timestep*sum);
+}
+
+/* ----------------------------------------------------------------------
+   print stats, with adaptive steps the last step, the range of steps
+   since the previous stats and the fraction of steps rejected
+------------------------------------------------------------------------- */
+
+void SolveGL::stats(char *strtmp)
+{
+  strtmp[0] = '\0';
+  if (!adaptive) return;
+
+  int ntry = naccept + nreject;
+  sprintf(strtmp," %10g %10g %10g %10g",dtstep,dt_lo,dt_hi,
+          ntry ? (double) nreject/ntry : 0.0);
+  dt_lo = dt_hi = dtstep;
+}
+
+/* ----------------------------------------------------------------------
+   print stats header
+------------------------------------------------------------------------- */
+
+void SolveGL::stats_header(char *strtmp)
+{
+  strtmp[0] = '\0';
+  if (!adaptive) return;
+
+  sprintf(strtmp," %10s %10s %10s %10s","Dt","DtLo","DtHi","Reject");
+}
@@ -31,11 +31,69 @@ class SolveGL : public Solve {
   ~SolveGL();
   
   void iterate();
+  void stats(char *);
+  void stats_header(char *);
 
   // This was private. Changed to protected. Inheritance (solve_linear_null)
  protected:
   class RandomPark *random;
-  
+
+  // adaptive step size from the energy change of each explicit step
+
+  int adaptive;         // 1 = adaptive step size, 0 = app's timestep
+  double dt;            // step size tried next
+  double dt_min,dt_max; // bounds on the step, 0 = 0.01 and 100 timesteps
+  double dt_grow;       // step growth factor while the energy decreases smoothly
+  double dtstep;        // last step taken
+  double dtprev;        // step of the rates in vold
+  double dt_lo,dt_hi;   // range of steps taken since the last stats
+  int naccept,nreject;  // accepted and rejected steps
+  int nxi;              // local length of xi
+  int havev;            // 1 if vold holds the rates of the last step
+  double *xold;         // xi at the start of the step
+  double *vold;         // d xi/dt of the last step
+
+  int adaptive_step();
+
+  // Anderson mixing of the fixed point xi -> xi + dt rate, each proc
+  // holds the history of its own part of xi
+
+  int nanderson;        // history depth m, 0 = no mixing
+  double beta;          // weight of the residual in the mixed step
+  int nhist;            // differences in the history
+  int ahead;            // slot of the newest difference
+  double *xprev,*rprev; // last iterate and its residual
+  double **dx,**dr;     // differences of iterates and of residuals
+  double **gram;        // dr_i.dr_j of the slots, same on all procs
+
+  void anderson_step();
+
+  // continuation predictor, each stress state after the first starts
+  // from xi extrapolated through the last converged states
+
+  int npredict;         // order, 0 = previous state, 1 = linear, 2 = quadratic
+  int nconv;            // converged states held in xconv
+  double **xconv;       // last npredict+1 converged xi, circular
+  int chead;            // slot of the newest
+  double xinorm_conv;   // residual the newest of them converged with
+  double *tauprev;      // resolved shear stresses of the previous state
+  double *nmobile;      // sites of each slip system moved by GL
+
+  void store_converged();
+  void predict_start();
+  double plain_residual();
+
+  // the first stress state relaxed on a grid coarser by a factor first,
+  // its xi spectrally prolongated to the input grid
+
+  int coarsen;          // coarsening factor, 1 = input grid only
+
+  void coarse_start();
+
+  int check_every;      // steps between reductions of the residual
+
+  int loop_keyword(int, char **, int);
+
 };
 
 }
@@ -43,3 +101,36 @@ class SolveGL : public Solve {
 #endif
 #endif
 
+
+/* ERROR/WARNING messages:
+
+E: Illegal solve_style command
+
+Self-explanatory.  Check the input script syntax and compare to the
+documentation for the command.
+
+E: solve_style GL adaptive and anderson cannot be combined
+
+Anderson mixing assumes the fixed point map of a constant step.
+
+E: solve_style GL anderson needs check_every 1
+
+Mixing is gated on the residual of every step.
+
+E: solve_style GL coarsen does not support glide_planes
+
+The glide planes are set up for the input grid only.
+
+E: solve_style GL coarsen does not support core_energy mpea
+
+The MPEA core energy is tabulated per site of the input grid.
+
+E: solve_style GL coarsen requires a 3d app
+
+The coarse grid is made by coarsening x, y and z alike.
+
+E: solve_style GL coarsen does not divide the grid
+
+The coarsening factor has to divide nx, ny and nz.
+
+*/
@@ -0,0 +1,138 @@
+/* ----------------------------------------------------------------------
+PFDD -- Phase Field Dislocation Dynamics
+
+© 2022. Triad National Security, LLC. All rights reserved.
+This program was produced under U.S. Government contract 89233218CNA000001 for
+Los Alamos National Laboratory (LANL), which is operated by Triad National
+Security, LLC for the U.S. Department of Energy/National Nuclear Security
+Administration. All rights in the program are reserved by Triad National
+Security, LLC, and the U.S. Department of Energy/National Nuclear Security
+Administration. The Government is granted for itself and others acting on its
+behalf a nonexclusive, paid-up, irrevocable worldwide license in this material 
+to reproduce, prepare derivative works, distribute copies to the public, perform
+ publicly and display publicly, and to permit others to do so.
+------------------------------------------------------------------------- */
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "solve_GL_semi_implicit.h"
+#include "error.h"
+#include "timer.h"
+#include "fft.h"
+#include "app.h"
+#include "output.h"
+
+using namespace PFDD_NS;
+
+/* ---------------------------------------------------------------------- */
+
+SolveGLSemiImplicit::SolveGLSemiImplicit(PFDD_C *pfdd_p, int narg, char **arg) :
+SolveGL(pfdd_p, 1, arg)
+{
+  dt_implicit = 0.0;
+  stab = 0.0;
+
+  int iarg = 1;
+  while (iarg < narg) {
+    int n = loop_keyword(narg,arg,iarg);
+    if (n) iarg += n;
+    else if (strcmp(arg[iarg],"dt") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal solve_style command");
+      dt_implicit = atof(arg[iarg+1]);
+      if (dt_implicit <= 0.0) error->all(FLERR,"Illegal solve_style command");
+      iarg += 2;
+    }
+    else if (strcmp(arg[iarg],"stab") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal solve_style command");
+      stab = atof(arg[iarg+1]);
+      if (stab < 0.0) error->all(FLERR,"Illegal solve_style command");
+      iarg += 2;
+    }
+    else error->all(FLERR,"Illegal solve_style command");
+  }
+}
+
+/* ----------------------------------------------------------------------
+   same loop as GL, one forward and one backward FFT per step, with
+   xi_new = xi - CD dt (B xi_new - tau + dE_core) solved in Fourier space,
+   stab S adds S (xi_new - xi) to damp the explicit core term
+   the coarse grid start of GL, if any, is relaxed with plain GL steps
+------------------------------------------------------------------------- */
+
+void SolveGLSemiImplicit::iterate()
+{
+  int ND = app->dimension;
+  int stopsteps = app->stopsteps;
+  double cdt = app->CD*(dt_implicit > 0.0 ? dt_implicit : app->timestep);
+
+  if (fft->nglide || fft->glide_auto)
+    error->all(FLERR,"solve_style GL_semi_implicit does not support glide_planes");
+
+  timer->stamp();
+
+  if (coarsen > 1) coarse_start();
+
+  if(me == 0){
+    printf("Beginning Time Evolution\n");
+  }
+
+  for(sstate = 0; sstate<stopsteps; sstate++){  // Loop on stress states
+    fft->rotate_stress();
+    app->resolSS();
+
+    for(int it=0; it<max_iter; it++){
+      // theta, only when read, and the core energy in one pass as in GL
+      fft->sweep();
+
+      // explicit part of the step, forward FFT and implicit solve of BB
+      fft->prepare_semi_implicit(cdt,stab);
+      fft->prep_forward();
+      fft->implicit_solve(cdt,stab);
+      fft->prep_backward();
+
+      // the residual is reduced every check_every steps and on the last
+      fft->check_norm = (it+1) % check_every == 0 || it == max_iter-1;
+      fft->update_order_parameter_implicit();
+      int converged = fft->check_norm && fft->xinorm < tol;
+
+      if (converged || fft->ximin > 1 || it == max_iter-1){
+        if(me==0)
+          printf("printing output it %d\n",it);
+        app->nextoutput = output->compute(app->time,1);
+      }
+      else if (app->time >= app->nextoutput){
+        app->nextoutput = output->compute(app->time,0);
+      }
+      timer->stamp(TIME_OUTPUT);
+
+      if(app->non_Schmid)
+        fft->project_core_energy();
+
+      timer->stamp(TIME_FFT);
+
+      app->time++;
+
+      if(converged){
+        if(me==0)
+          printf("Loading step %d converged after %d iterations\n",sstate,it);
+        break;
+      }
+      if(fft->ximin > 1){
+        if(me==0)
+          printf("Minimum order parameter > 1 on slip plane (exiting)\n");
+        it=max_iter;
+        sstate=stopsteps;
+      }
+    }
+
+    // increment sigma
+    for (int i=0; i<ND; i++){
+      for (int j=0; j<ND; j++){
+        fft->sigma[i][j] = fft->sigma[i][j] + fft->deltasig[i][j];
+      }
+    }
+  }
+  fft->check_norm = 1;
+  timer->stamp(TIME_SOLVE);
+}
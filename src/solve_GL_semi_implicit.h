@@ -0,0 +1,60 @@
+/* ----------------------------------------------------------------------
+PFDD -- Phase Field Dislocation Dynamics
+
+© 2022. Triad National Security, LLC. All rights reserved.
+This program was produced under U.S. Government contract 89233218CNA000001 for
+Los Alamos National Laboratory (LANL), which is operated by Triad National
+Security, LLC for the U.S. Department of Energy/National Nuclear Security
+Administration. All rights in the program are reserved by Triad National
+Security, LLC, and the U.S. Department of Energy/National Nuclear Security
+Administration. The Government is granted for itself and others acting on its
+behalf a nonexclusive, paid-up, irrevocable worldwide license in this material 
+to reproduce, prepare derivative works, distribute copies to the public, perform
+ publicly and display publicly, and to permit others to do so.
+------------------------------------------------------------------------- */
+
+#ifdef SOLVE_CLASS
+SolveStyle(GL_semi_implicit,SolveGLSemiImplicit)
+
+#else
+
+#ifndef PFDD_SOLVE_GL_SEMI_IMPLICIT_H
+#define PFDD_SOLVE_GL_SEMI_IMPLICIT_H
+
+#include "solve_GL.h"
+
+namespace PFDD_NS {
+
+// Ginzburg-Landau with the elastic interaction BB taken implicitly in
+// Fourier space and the core energy and applied stress explicitly
+
+class SolveGLSemiImplicit : public SolveGL {
+ public:
+  SolveGLSemiImplicit(class PFDD_C *, int, char **);
+  ~SolveGLSemiImplicit() {}
+
+  void iterate();
+
+ protected:
+  double dt_implicit;   // time step, 0 = the app's timestep
+  double stab;          // S xi added implicitly and taken out explicitly
+};
+
+}
+
+#endif
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Illegal solve_style command
+
+Self-explanatory.  Check the input script syntax and compare to the
+documentation for the command.
+
+E: solve_style GL_semi_implicit does not support glide_planes
+
+The sparse glide plane transform reads xi itself and cannot transform
+the explicit part of the step.
+
+*/
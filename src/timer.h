@@ -20,7 +20,7 @@ to reproduce, prepare derivative works, distribute copies to the public, perform
 
 namespace PFDD_NS {
 
-enum{TIME_LOOP,TIME_SOLVE,TIME_COMM,TIME_OUTPUT,TIME_FFT,TIME_APP,TIME_N};
+enum{TIME_LOOP,TIME_SOLVE,TIME_COMM,TIME_OUTPUT,TIME_FFT,TIME_APP,TIME_SETUP,TIME_N};
 
 class Timer : protected Pointers {
  public: